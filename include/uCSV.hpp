@@ -22,6 +22,16 @@
 #include <tuple>
 #include <cassert>
 #include <optional>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <initializer_list>
+#include <functional>
+#include <limits>
+#if __cplusplus > 201703L && __has_include(<ranges>)
+#include <ranges>
+#endif
 
 namespace uCSV
 {
@@ -34,6 +44,70 @@ namespace uCSV
 		return x == '\n' || x == '\r';
 	}
 
+	namespace Detail
+	{
+		[[nodiscard]] inline std::uint64_t load64(unsigned char const* p) noexcept
+		{
+			std::uint64_t x;
+			std::memcpy(&x, p, sizeof(x));
+			return x;
+		}
+		[[nodiscard]] inline std::uint64_t loadTail(unsigned char const* p, std::size_t n) noexcept
+		{
+			assert(n < 8);
+			std::uint64_t x = 0;
+			if(n == 0)
+				return x;
+			std::memcpy(&x, p, n);
+			return x;
+		}
+		// folded 64x64->128 bit multiplication
+		[[nodiscard]] inline std::uint64_t mum(std::uint64_t a, std::uint64_t b) noexcept
+		{
+#ifdef __SIZEOF_INT128__
+			__extension__ using uint128_t = unsigned __int128;
+			const uint128_t r = static_cast<uint128_t>(a) * b;
+			return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+			const std::uint64_t aLo = a & 0xFFFFFFFF, aHi = a >> 32;
+			const std::uint64_t bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+			const std::uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+			const std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+			const std::uint64_t lo = (mid << 32) | (ll & 0xFFFFFFFF);
+			const std::uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+			return lo ^ hi;
+#endif
+		}
+	}
+
+	// a fast non-cryptographic 64 bit hash in the spirit of wyhash. the result depends on the byte order of the platform
+	[[nodiscard]] inline std::uint64_t hash(void const* data, std::size_t size, std::uint64_t seed = 0) noexcept
+	{
+		constexpr std::uint64_t p0 = 0xa0761d6478bd642full;
+		constexpr std::uint64_t p1 = 0xe7037ed1a0b428dbull;
+		constexpr std::uint64_t p2 = 0x8ebc6af09c88c6e3ull;
+
+		auto p = static_cast<unsigned char const*>(data);
+		std::uint64_t state = seed ^ p0;
+		std::size_t n = size;
+		for(; n >= 16; n -= 16, p += 16)
+			state = Detail::mum(Detail::load64(p) ^ p1, Detail::load64(p + 8) ^ state);
+		std::uint64_t a = 0, b = 0;
+		if(n >= 8)
+		{
+			a = Detail::load64(p);
+			b = Detail::loadTail(p + 8, n - 8);
+		}
+		else
+			a = Detail::loadTail(p, n);
+		state = Detail::mum(a ^ p1, b ^ state);
+		return Detail::mum(state ^ p2, static_cast<std::uint64_t>(size) ^ p1);
+	}
+	[[nodiscard]] inline std::uint64_t hash(string_view_t str, std::uint64_t seed = 0) noexcept
+	{
+		return hash(str.data(), str.size(), seed);
+	}
+
 	template<typename T>
 	[[nodiscard]] constexpr T const& constify(T const& x) noexcept
 	{
@@ -112,6 +186,13 @@ namespace uCSV
 				throw std::out_of_range("uCSV::Deserializer: attempting to access more columns that there are");
 			return mCells[mIndex++];
 		}
+		// random access to the cells of the row, independent of the position of next()
+		[[nodiscard]] constexpr string_view_t cell(std::size_t index) const
+		{
+			if(index >= mColumns)
+				throw std::out_of_range("uCSV::Deserializer: attempting to access more columns that there are");
+			return mCells[index];
+		}
 
 	private:
 		std::size_t mIndex = 0;
@@ -120,9 +201,13 @@ namespace uCSV
 		string_view_t const* mCells;
 	};
 
-	inline void deserialize(Deserializer& data, string_t& target)
+	// any allocator, e.g. a std::pmr::polymorphic_allocator over a std::pmr::monotonic_buffer_resource, which lets bulk
+	// loads copy the cells into large chunks that are freed all at once
+	template<typename TraitsT, typename AllocatorT>
+	void deserialize(Deserializer& data, std::basic_string<char_t, TraitsT, AllocatorT>& target)
 	{
-		target = data.next();
+		const string_view_t next = data.next();
+		target.assign(next.data(), next.size());
 	}
 	constexpr void deserialize(Deserializer& data, string_view_t& target)
 	{
@@ -147,18 +232,331 @@ namespace uCSV
 		if(end == next.data())
 			throw std::runtime_error("uCSV::deserialize: failed to convert string to double");
 	}
+
+	namespace Detail
+	{
+		// the lanes of a word are the bytes in input order, regardless of the byte order of the platform
+		[[nodiscard]] constexpr std::uint64_t loadLanes(char_t const* p, std::size_t n) noexcept
+		{
+			std::uint64_t result = 0;
+			for(std::size_t i = 0; i < n; ++i)
+				result |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+			return result;
+		}
+		[[nodiscard]] constexpr std::uint64_t laneMask(std::initializer_list<unsigned> lanes) noexcept
+		{
+			std::uint64_t result = 0;
+			for(const unsigned lane : lanes)
+				result |= std::uint64_t(0xFF) << (8 * lane);
+			return result;
+		}
+		// checks that the lanes selected by digits are ASCII digits and all other lanes equal pattern. returns the
+		// word with every digit lane d replaced by 10 * d + (next lane)
+		[[nodiscard]] constexpr std::optional<std::uint64_t> swarPairs(std::uint64_t word, std::uint64_t digits, std::uint64_t pattern) noexcept
+		{
+			constexpr std::uint64_t zeros = 0x3030303030303030;
+			constexpr std::uint64_t high = 0xF0F0F0F0F0F0F0F0;
+			constexpr std::uint64_t sixes = 0x0606060606060606;
+			const std::uint64_t x = (word & digits) | (zeros & ~digits);
+			if((word & ~digits) != (pattern & ~digits) || (x & high) != zeros || ((x + sixes) & high) != zeros)
+				return std::nullopt;
+			const std::uint64_t v = (word ^ zeros) & digits;
+			return v * 10 + (v >> 8);
+		}
+		[[nodiscard]] constexpr unsigned lane(std::uint64_t word, unsigned index) noexcept
+		{
+			return static_cast<unsigned>((word >> (8 * index)) & 0xFF);
+		}
+
+		// http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+		[[nodiscard]] constexpr std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d) noexcept
+		{
+			y -= m <= 2;
+			const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+			const auto yoe = static_cast<unsigned>(y - era * 400);
+			const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+			const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+		}
+		[[nodiscard]] constexpr unsigned daysInMonth(unsigned y, unsigned m) noexcept
+		{
+			constexpr unsigned char days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+			const bool leap = y % 4 == 0 && (y % 100 != 0 || y % 400 == 0);
+			return days[m - 1] + (m == 2 && leap);
+		}
+
+		struct Date
+		{
+			unsigned year, month, day;
+		};
+		// YYYY-MM-DD
+		[[nodiscard]] constexpr std::optional<Date> parseDate(string_view_t str) noexcept
+		{
+			if(str.size() < 10)
+				return std::nullopt;
+			const auto first = swarPairs(loadLanes(str.data(), 8), laneMask({ 0, 1, 2, 3, 5, 6 }), loadLanes("0000-00-", 8));
+			const auto second = swarPairs(loadLanes(str.data() + 8, 2), laneMask({ 0, 1 }), 0);
+			if(!first || !second)
+				return std::nullopt;
+			const Date result{ lane(*first, 0) * 100 + lane(*first, 2), lane(*first, 5), lane(*second, 0) };
+			if(result.month < 1 || result.month > 12 || result.day < 1 || result.day > daysInMonth(result.year, result.month))
+				return std::nullopt;
+			return result;
+		}
+		// hh:mm:ss[.fffffffff] of at most 99 hours, returned in nanoseconds. the number of characters consumed is
+		// stored in length
+		[[nodiscard]] constexpr std::optional<std::int64_t> parseTime(string_view_t str, std::size_t& length) noexcept
+		{
+			if(str.size() < 8)
+				return std::nullopt;
+			const auto pairs = swarPairs(loadLanes(str.data(), 8), laneMask({ 0, 1, 3, 4, 6, 7 }), loadLanes("00:00:00", 8));
+			if(!pairs)
+				return std::nullopt;
+			const unsigned minutes = lane(*pairs, 3), seconds = lane(*pairs, 6);
+			if(minutes > 59 || seconds > 59)
+				return std::nullopt;
+			std::int64_t result = ((std::int64_t(lane(*pairs, 0)) * 60 + minutes) * 60 + seconds) * 1000000000;
+			length = 8;
+			if(length < str.size() && (str[length] == '.' || str[length] == ','))
+			{
+				std::int64_t fraction = 0, scale = 1000000000;
+				std::size_t i = length + 1;
+				for(; i < str.size() && str[i] >= '0' && str[i] <= '9'; ++i)
+					if(i - length <= 9)
+					{
+						fraction = fraction * 10 + (str[i] - '0');
+						scale /= 10;
+					}
+				if(i == length + 1)
+					return std::nullopt;
+				result += fraction * scale;
+				length = i;
+			}
+			return result;
+		}
+		// Z, ±hh:mm, ±hhmm or ±hh; returns the offset from UTC in minutes
+		[[nodiscard]] constexpr std::optional<int> parseOffset(string_view_t str) noexcept
+		{
+			if(str == "Z" || str == "z")
+				return 0;
+			if(str.size() < 3 || (str[0] != '+' && str[0] != '-'))
+				return std::nullopt;
+			const int sign = str[0] == '-' ? -1 : 1;
+			std::uint64_t digits = 0, pattern = 0;
+			switch(str.size())
+			{
+			case 3:
+				digits = laneMask({ 1, 2 });
+				pattern = 0;
+				break;
+			case 5:
+				digits = laneMask({ 1, 2, 3, 4 });
+				pattern = 0;
+				break;
+			case 6:
+				digits = laneMask({ 1, 2, 4, 5 });
+				pattern = loadLanes("+00:00", 6) & ~std::uint64_t(0xFF);
+				break;
+			default:
+				return std::nullopt;
+			}
+			const auto pairs = swarPairs(loadLanes(str.data(), str.size()) & ~std::uint64_t(0xFF), digits, pattern);
+			if(!pairs)
+				return std::nullopt;
+			const unsigned hours = lane(*pairs, 1);
+			const unsigned minutes = str.size() == 3 ? 0 : lane(*pairs, str.size() == 5 ? 3 : 4);
+			if(hours > 23 || minutes > 59)
+				return std::nullopt;
+			return sign * static_cast<int>(hours * 60 + minutes);
+		}
+
+		// YYYY-MM-DD[(T| )hh:mm:ss[.fffffffff][Z|±hh:mm]], returned in nanoseconds since the epoch split into days and
+		// nanoseconds of the day (which may be negative or exceed a day due to the offset)
+		[[nodiscard]] constexpr std::optional<std::pair<std::int64_t, std::int64_t>> parseTimestamp(string_view_t str) noexcept
+		{
+			const auto date = parseDate(str);
+			if(!date)
+				return std::nullopt;
+			const std::int64_t days = daysFromCivil(date->year, date->month, date->day);
+			if(str.size() == 10)
+				return std::pair<std::int64_t, std::int64_t>(days, 0);
+			if(str[10] != 'T' && str[10] != 't' && str[10] != ' ')
+				return std::nullopt;
+			std::size_t length = 0;
+			const auto time = parseTime(str.substr(11), length);
+			if(!time || *time >= std::int64_t(86400) * 1000000000)
+				return std::nullopt;
+			std::int64_t nanoseconds = *time;
+			const string_view_t rest = str.substr(11 + length);
+			if(!rest.empty())
+			{
+				const auto offset = parseOffset(rest);
+				if(!offset)
+					return std::nullopt;
+				nanoseconds -= std::int64_t(*offset) * 60 * 1000000000;
+			}
+			return std::pair<std::int64_t, std::int64_t>(days, nanoseconds);
+		}
+
+		// acc = acc * factor + addend for non-negative operands; returns false instead of overflowing
+		[[nodiscard]] constexpr bool mulAdd(std::int64_t& acc, std::int64_t factor, std::int64_t addend) noexcept
+		{
+			constexpr std::int64_t max = std::numeric_limits<std::int64_t>::max();
+			if(factor != 0 && acc > (max - addend) / factor)
+				return false;
+			acc = acc * factor + addend;
+			return true;
+		}
+
+		// [-]hh:mm:ss[.fffffffff] or ISO 8601 P[nW][nD][T[nH][nM][n[.fffffffff]S]], returned in nanoseconds
+		[[nodiscard]] constexpr std::optional<std::int64_t> parseDuration(string_view_t str) noexcept
+		{
+			bool negative = false;
+			if(!str.empty() && (str[0] == '-' || str[0] == '+'))
+			{
+				negative = str[0] == '-';
+				str.remove_prefix(1);
+			}
+			if(str.empty())
+				return std::nullopt;
+
+			std::int64_t result = 0;
+			if(str[0] == 'P' || str[0] == 'p')
+			{
+				constexpr std::int64_t second = 1000000000;
+				bool time = false, any = false;
+				for(std::size_t i = 1; i < str.size();)
+				{
+					if(str[i] == 'T' || str[i] == 't')
+					{
+						if(time)
+							return std::nullopt;
+						time = true;
+						++i;
+						continue;
+					}
+					std::int64_t value = 0, fraction = 0, scale = second;
+					const std::size_t begin = i;
+					for(; i < str.size() && str[i] >= '0' && str[i] <= '9'; ++i)
+						if(!mulAdd(value, 10, str[i] - '0'))
+							return std::nullopt;
+					if(i == begin || i == str.size())
+						return std::nullopt;
+					if(str[i] == '.' || str[i] == ',')
+					{
+						const std::size_t point = i++;
+						for(; i < str.size() && str[i] >= '0' && str[i] <= '9'; ++i)
+							if(i - point <= 9)
+							{
+								fraction = fraction * 10 + (str[i] - '0');
+								scale /= 10;
+							}
+						if(i == str.size() || (str[i] != 'S' && str[i] != 's'))
+							return std::nullopt;
+					}
+					std::int64_t unit = 0;
+					switch(str[i])
+					{
+					case 'W': case 'w': unit = time ? 0 : 7 * 86400 * second; break;
+					case 'D': case 'd': unit = time ? 0 : 86400 * second; break;
+					case 'H': case 'h': unit = time ? 3600 * second : 0; break;
+					case 'M': case 'm': unit = time ? 60 * second : 0; break; // months are ambiguous, hence unsupported
+					case 'S': case 's': unit = time ? second : 0; break;
+					default: unit = 0; break;
+					}
+					if(unit == 0)
+						return std::nullopt;
+					if(!mulAdd(value, unit, fraction * scale) || !mulAdd(result, 1, value))
+						return std::nullopt;
+					any = true;
+					++i;
+				}
+				if(!any)
+					return std::nullopt;
+			}
+			else
+			{
+				// the hours may have more than two digits
+				std::size_t hoursLength = 0;
+				while(hoursLength < str.size() && str[hoursLength] >= '0' && str[hoursLength] <= '9')
+					++hoursLength;
+				if(hoursLength < 2)
+					return std::nullopt;
+				std::int64_t hours = 0;
+				for(std::size_t i = 0; i < hoursLength - 2; ++i)
+					if(!mulAdd(hours, 10, str[i] - '0'))
+						return std::nullopt;
+				std::size_t length = 0;
+				const auto time = parseTime(str.substr(hoursLength - 2), length);
+				if(!time || hoursLength - 2 + length != str.size())
+					return std::nullopt;
+				result = hours;
+				if(!mulAdd(result, std::int64_t(100) * 3600 * 1000000000, *time))
+					return std::nullopt;
+			}
+			return negative ? -result : result;
+		}
+	}
+
+	// UTC timestamps of the form YYYY-MM-DD[(T| )hh:mm:ss[.fffffffff][Z|±hh:mm]]; local times without an offset are
+	// interpreted as UTC. fractions finer than Duration are rounded down
+	template<typename Duration>
+	void deserialize(Deserializer& data, std::chrono::time_point<std::chrono::system_clock, Duration>& target)
+	{
+		const auto parsed = Detail::parseTimestamp(data.next());
+		if(!parsed)
+			throw std::runtime_error("uCSV::deserialize: failed to convert string to time point");
+		using days = std::chrono::duration<std::int64_t, std::ratio<86400>>;
+		const std::chrono::time_point<std::chrono::system_clock, days> day(days(parsed->first));
+		target = std::chrono::time_point_cast<Duration>(day) + std::chrono::floor<Duration>(std::chrono::nanoseconds(parsed->second));
+	}
+	// [-]hh:mm:ss[.fffffffff] or ISO 8601 durations without years and months, such as PT1H30M or P2DT0.5S
+	template<typename Rep, typename Period>
+	void deserialize(Deserializer& data, std::chrono::duration<Rep, Period>& target)
+	{
+		const auto parsed = Detail::parseDuration(data.next());
+		if(!parsed)
+			throw std::runtime_error("uCSV::deserialize: failed to convert string to duration");
+		target = std::chrono::duration_cast<std::chrono::duration<Rep, Period>>(std::chrono::nanoseconds(*parsed));
+	}
+#if defined(__cpp_lib_chrono) && __cpp_lib_chrono >= 201907L
+	inline void deserialize(Deserializer& data, std::chrono::year_month_day& target)
+	{
+		const string_view_t next = data.next();
+		const auto parsed = next.size() == 10 ? Detail::parseDate(next) : std::nullopt;
+		if(!parsed)
+			throw std::runtime_error("uCSV::deserialize: failed to convert string to date");
+		target = std::chrono::year_month_day(std::chrono::year(static_cast<int>(parsed->year)), std::chrono::month(parsed->month), std::chrono::day(parsed->day));
+	}
+#endif
 	// TODO: other containers and ranges too, also iterators
-	template<typename T>
-	constexpr void deserialize(Deserializer& data, std::vector<T>& target)
+	// the elements already in target are deserialized into, which lets them reuse their memory. new elements are
+	// constructed in place, so that they use the allocator of target if they are allocator-aware, e.g. the elements of
+	// a std::pmr::vector<std::pmr::string>
+	template<typename T, typename AllocatorT>
+	void deserialize(Deserializer& data, std::vector<T, AllocatorT>& target)
 	{
-		target.clear();
 		// target.reserve(data.remaining()); // deserialize might consume more than one cell
-		while(data.remaining())
+		std::size_t size = 0;
+		for(; data.remaining(); ++size)
 		{
-			T next;
-			deserialize(data, next);
-			target.emplace_back(std::move(next));
+			if(size < target.size())
+				deserialize(data, target[size]);
+			else
+			{
+				target.emplace_back();
+				try
+				{
+					deserialize(data, target.back());
+				}
+				catch(...)
+				{
+					target.pop_back();
+					throw;
+				}
+			}
 		}
+		target.erase(target.begin() + static_cast<std::ptrdiff_t>(size), target.end());
 	}
 
 	namespace Detail
@@ -182,6 +580,67 @@ namespace uCSV
 		(deserialize(data, args), ...);
 	}
 
+	// the value types of the columnar exports. the values are part of the sidecar file format
+	enum class ColumnType : std::uint64_t
+	{
+		int64,
+		float64,
+		string,
+	};
+	namespace Detail
+	{
+		// the conversions of the columnar exports; false if the cell doesn't hold a value of the type. like for deserialize,
+		// the cell has to be followed by a character which can't continue a number, as the cells of a Reader are
+		[[nodiscard]] inline bool convertCell(string_view_t cell, std::int64_t& value) noexcept
+		{
+			const auto end = cell.data() + cell.size();
+			const auto [ptr, ec] = std::from_chars(cell.data(), end, value);
+			return ec == std::errc() && ptr == end;
+		}
+		// the whole cell has to be a decimal number, hence unlike for deserialize there may be no leading whitespace, trailing
+		// characters, infinities or NaNs
+		[[nodiscard]] inline bool convertCell(string_view_t cell, double& value) noexcept
+		{
+			const std::size_t first = !cell.empty() && (cell[0] == '-' || cell[0] == '+');
+			if(first >= cell.size() || !((cell[first] >= '0' && cell[first] <= '9') || cell[first] == '.'))
+				return false;
+			char_t* end;
+			value = std::strtod(cell.data(), &end);
+			return end == cell.data() + cell.size();
+		}
+	}
+
+	// bounds on the memory a single record may take, which protect against malformed or hostile input such as an
+	// unterminated quote. a record exceeding them is reported and skipped; see Reader::limits
+	enum class Limit
+	{
+		cellBytes,
+		rowBytes,
+		columns,
+	};
+	struct Limits
+	{
+		std::size_t cellBytes = ~std::size_t(0);
+		std::size_t rowBytes = ~std::size_t(0);
+		std::size_t columns = ~std::size_t(0);
+	};
+	namespace Detail
+	{
+		[[nodiscard]] constexpr char const* limitName(Limit limit) noexcept
+		{
+			switch(limit)
+			{
+			case Limit::cellBytes:
+				return "cell size";
+			case Limit::rowBytes:
+				return "row size";
+			case Limit::columns:
+				return "number of columns";
+			}
+			return "";
+		}
+	}
+
 	struct ErrorIgnore
 	{
 		constexpr void raiseIncorrectColumns(unsigned int provided, unsigned int expected, unsigned int row) noexcept
@@ -199,6 +658,17 @@ namespace uCSV
 			(void)row; // -Wunused-argument
 			(void)column; // -Wunused-argument
 		}
+		constexpr void raiseBadEncoding(unsigned int column, unsigned int row) noexcept
+		{
+			(void)row; // -Wunused-argument
+			(void)column; // -Wunused-argument
+		}
+		constexpr void raiseLimitExceeded(Limit limit, unsigned int column, unsigned int row) noexcept
+		{
+			(void)limit; // -Wunused-argument
+			(void)row; // -Wunused-argument
+			(void)column; // -Wunused-argument
+		}
 	};
 	class ErrorFlags
 	{
@@ -221,6 +691,19 @@ namespace uCSV
 			(void)column; // -Wunused-argument
 			mBadCell = true;
 		}
+		constexpr void raiseBadEncoding(unsigned int column, unsigned int row) noexcept
+		{
+			(void)row; // -Wunused-argument
+			(void)column; // -Wunused-argument
+			mBadEncoding = true;
+		}
+		constexpr void raiseLimitExceeded(Limit limit, unsigned int column, unsigned int row) noexcept
+		{
+			(void)limit; // -Wunused-argument
+			(void)row; // -Wunused-argument
+			(void)column; // -Wunused-argument
+			mLimitExceeded = true;
+		}
 
 		[[nodiscard]] constexpr bool incorrectColumns() const noexcept
 		{
@@ -234,24 +717,38 @@ namespace uCSV
 		{
 			return mBadCell;
 		}
+		[[nodiscard]] constexpr bool badEncoding() const noexcept
+		{
+			return mBadEncoding;
+		}
+		[[nodiscard]] constexpr bool limitExceeded() const noexcept
+		{
+			return mLimitExceeded;
+		}
 
 		[[nodiscard]] constexpr bool good() const noexcept
 		{
 			return !mIncorrectColumns
 				&& !mUnexpectedEnd
-				&& !mBadCell;
+				&& !mBadCell
+				&& !mBadEncoding
+				&& !mLimitExceeded;
 		}
 		constexpr void clear() noexcept
 		{
 			mIncorrectColumns = false;
 			mUnexpectedEnd = false;
 			mBadCell = false;
+			mBadEncoding = false;
+			mLimitExceeded = false;
 		}
 
 	private:
 		bool mIncorrectColumns = false;
 		bool mUnexpectedEnd = false;
 		bool mBadCell = false;
+		bool mBadEncoding = false;
+		bool mLimitExceeded = false;
 	};
 	template<typename ExceptionT = std::runtime_error>
 	struct ErrorThrow
@@ -270,6 +767,14 @@ namespace uCSV
 		{
 			throw ExceptionType("uCSV: bad cell in column " + std::to_string(column) + " and line " + std::to_string(row));
 		}
+		[[noreturn]] constexpr void raiseBadEncoding(unsigned int column, unsigned int row)
+		{
+			throw ExceptionType("uCSV: invalid UTF-8 in column " + std::to_string(column) + " and line " + std::to_string(row));
+		}
+		[[noreturn]] constexpr void raiseLimitExceeded(Limit limit, unsigned int column, unsigned int row)
+		{
+			throw ExceptionType(string_t("uCSV: ") + Detail::limitName(limit) + " limit exceeded in column " + std::to_string(column) + " and line " + std::to_string(row));
+		}
 	};
 	template<typename StreamT = std::ostream>
 	class ErrorLog
@@ -294,16 +799,32 @@ namespace uCSV
 		{
 			*mSink << "uCSV: bad cell in column " << column << " and line " << row << '\n';
 		}
+		constexpr void raiseBadEncoding(unsigned int column, unsigned int row) noexcept
+		{
+			*mSink << "uCSV: invalid UTF-8 in column " << column << " and line " << row << '\n';
+		}
+		constexpr void raiseLimitExceeded(Limit limit, unsigned int column, unsigned int row) noexcept
+		{
+			*mSink << "uCSV: " << Detail::limitName(limit) << " limit exceeded in column " << column << " and line " << row << '\n';
+		}
 
 	private:
 		StreamType* mSink;
 	};
 
+	namespace Detail
+	{
+		// error handlers written before the limits existed report them as bad cells
+		template<typename ErrorHandlerT, typename = void>
+		struct HasLimitHook : std::false_type {};
+		template<typename ErrorHandlerT>
+		struct HasLimitHook<ErrorHandlerT, std::void_t<decltype(std::declval<ErrorHandlerT&>().raiseLimitExceeded(Limit::cellBytes, 0u, 0u))>> : std::true_type {};
+	}
+
 	template<char_t... delimiters>
 	struct Delimiter
 	{
 		static_assert(sizeof...(delimiters) >= 1, "at least one delimiter required");
-		static_assert(((delimiters != '"') && ...), "the reserved character \" may not be a delimitor");
 		static_assert(((delimiters != '\r') && ...), "newlines may not be a delimitor");
 		static_assert(((delimiters != '\n') && ...), "newlines may not be a delimitor");
 
@@ -315,21 +836,155 @@ namespace uCSV
 
 	using DefaultDelimiter = Delimiter<','>;
 
+	namespace Detail
+	{
+		template<typename T>
+		inline constexpr bool isDelimiterMatcher = std::is_invocable_r_v<bool, T const&, char_t>;
+
+		// the delimiters of a Delimiter are known at compile time, those of custom matchers only at run time
+		template<typename T>
+		struct StaticDelimiter
+		{
+			static constexpr bool known = false;
+			static constexpr bool matches(char_t) noexcept
+			{
+				return false;
+			}
+		};
+		template<char_t... delimiters>
+		struct StaticDelimiter<Delimiter<delimiters...>>
+		{
+			static constexpr bool known = true;
+			static constexpr bool matches(char_t c) noexcept
+			{
+				return ((c == delimiters) || ...);
+			}
+		};
+
+		// containers with contiguous characters, such as strings, string views and character arrays
+		template<typename T, typename = void>
+		struct IsCharRange : std::false_type {};
+		template<typename T>
+		struct IsCharRange<T, std::enable_if_t<
+			std::is_same_v<decltype(std::data(std::declval<T const&>())), char_t const*>
+			&& std::is_convertible_v<decltype(std::size(std::declval<T const&>())), std::size_t>
+		>> : std::true_type {};
+		template<typename T>
+		[[nodiscard]] constexpr string_view_t charRange(T const& container) noexcept
+		{
+			return string_view_t(std::data(container), std::size(container));
+		}
+
+		// the escaping kernels process eight characters at once, the lanes of a word being the bytes in memory order
+		inline constexpr std::uint64_t lowLanes = 0x0101010101010101;
+		[[nodiscard]] constexpr std::uint64_t broadcast(char_t c) noexcept
+		{
+			return lowLanes * static_cast<unsigned char>(c);
+		}
+		// the high bit is set in every lane of x that equals c, without false positives
+		[[nodiscard]] constexpr std::uint64_t matchLanes(std::uint64_t x, char_t c) noexcept
+		{
+			constexpr std::uint64_t low7 = 0x7F7F7F7F7F7F7F7F;
+			x ^= broadcast(c);
+			return ~(((x & low7) + low7) | x | low7);
+		}
+		[[nodiscard]] constexpr std::size_t countLanes(std::uint64_t matches) noexcept
+		{
+			return static_cast<std::size_t>(((matches >> 7) * lowLanes) >> 56);
+		}
+
+		template<char_t... delimiters>
+		[[nodiscard]] inline bool needsEscaping(string_view_t str, Delimiter<delimiters...> const&) noexcept
+		{
+			auto const* const data = reinterpret_cast<unsigned char const*>(str.data());
+			const std::size_t size = str.size();
+			std::size_t i = 0;
+			for(; i + 8 <= size; i += 8)
+			{
+				const std::uint64_t x = load64(data + i);
+				if(matchLanes(x, '"') | matchLanes(x, '\r') | matchLanes(x, '\n') | (matchLanes(x, delimiters) | ...))
+					return true;
+			}
+			for(; i < size; ++i)
+			{
+				const char_t c = str[i];
+				if(isNewline(c) || c == '"' || ((c == delimiters) || ...))
+					return true;
+			}
+			return false;
+		}
+		template<typename DelimiterMatcherT>
+		[[nodiscard]] constexpr bool needsEscaping(string_view_t str, DelimiterMatcherT const& delimiterMatcher)
+		{
+			return std::any_of(str.begin(), str.end(), [&delimiterMatcher](char_t c) constexpr noexcept { return isNewline(c) || c == '"' || delimiterMatcher(c); });
+		}
+
+		// escaping stops at the first zero character
+		[[nodiscard]] inline string_view_t escapable(string_view_t str) noexcept
+		{
+			if(str.empty())
+				return str;
+			if(void const* const zero = std::memchr(str.data(), '\0', str.size()))
+				str = str.substr(0, static_cast<std::size_t>(static_cast<char_t const*>(zero) - str.data()));
+			return str;
+		}
+		[[nodiscard]] inline std::size_t countQuotes(string_view_t str) noexcept
+		{
+			auto const* const data = reinterpret_cast<unsigned char const*>(str.data());
+			const std::size_t size = str.size();
+			std::size_t result = 0;
+			std::size_t i = 0;
+			for(; i + 8 <= size; i += 8)
+				result += countLanes(matchLanes(load64(data + i), '"'));
+			for(; i < size; ++i)
+				result += str[i] == '"';
+			return result;
+		}
+		// copies the runs between quotes as blocks
+		template<typename OutputIteratorType>
+		OutputIteratorType escape(string_view_t str, OutputIteratorType out)
+		{
+			str = escapable(str);
+			*out++ = '"';
+			while(!str.empty())
+			{
+				void const* const quote = std::memchr(str.data(), '"', str.size());
+				const std::size_t run = quote ? static_cast<std::size_t>(static_cast<char_t const*>(quote) - str.data()) + 1 : str.size();
+				out = std::copy_n(str.data(), run, out);
+				if(quote)
+					*out++ = '"';
+				str.remove_prefix(run);
+			}
+			*out++ = '"';
+			return out;
+		}
+	}
+
 	template<typename InputIteratorFirstType, typename InputIteratorLastType, typename DelimiterMatcherT>
 	[[nodiscard]] constexpr bool needsEscaping(InputIteratorFirstType first, InputIteratorLastType last, DelimiterMatcherT const& delimiterMatcher)
 	{
 		return std::any_of(first, last, [&delimiterMatcher](char_t c) constexpr noexcept { return isNewline(c) || c == '"' || delimiterMatcher(c); });
 	}
-	template<typename InputIteratorFirstType, typename InputIteratorLastType>
+	template<typename InputIteratorFirstType, typename InputIteratorLastType, typename = std::enable_if_t<!Detail::isDelimiterMatcher<InputIteratorLastType>>>
 	[[nodiscard]] constexpr bool needsEscaping(InputIteratorFirstType first, InputIteratorLastType last)
 	{
 		return needsEscaping<InputIteratorFirstType, InputIteratorLastType>(std::move(first), std::move(last), DefaultDelimiter());
 	}
+	template<typename ContainerType, typename DelimiterMatcherT, typename = std::enable_if_t<Detail::isDelimiterMatcher<DelimiterMatcherT>>>
+	[[nodiscard]] constexpr bool needsEscaping(ContainerType const& container, DelimiterMatcherT const& delimiterMatcher)
+	{
+		if constexpr(Detail::IsCharRange<ContainerType>::value)
+			return Detail::needsEscaping(Detail::charRange(container), delimiterMatcher);
+		else
+		{
+			using std::begin, std::end;
+			return needsEscaping(begin(container), end(container), delimiterMatcher);
+		}
+	}
 	template<typename ContainerType>
 	[[nodiscard]] constexpr bool needsEscaping(ContainerType const& container)
 	{
-		using std::begin, std::end;
-		return needsEscaping(begin(container), end(container));
+		return needsEscaping(container, DefaultDelimiter());
 	}
 
 	template<typename InputIteratorFirstType, typename InputIteratorLastType, typename OutputIteratorType>
@@ -351,8 +1006,22 @@ namespace uCSV
 	template<typename ContainerType, typename OutputIteratorType>
 	constexpr OutputIteratorType escape(ContainerType const& container, OutputIteratorType out)
 	{
-		using std::begin, std::end;
-		return escape(begin(container), end(container), out);
+		if constexpr(Detail::IsCharRange<ContainerType>::value)
+			return Detail::escape(Detail::charRange(container), std::move(out));
+		else
+		{
+			using std::begin, std::end;
+			return escape(begin(container), end(container), std::move(out));
+		}
+	}
+
+	// the number of characters escape writes for a container of characters
+	template<typename ContainerType>
+	[[nodiscard]] std::size_t escapedSize(ContainerType const& container) noexcept
+	{
+		static_assert(Detail::IsCharRange<ContainerType>::value, "the characters have to be contiguous");
+		const string_view_t str = Detail::escapable(Detail::charRange(container));
+		return str.size() + Detail::countQuotes(str) + 2;
 	}
 
 	template<typename InputIteratorFirstType, typename InputIteratorLastType>
@@ -365,34 +1034,272 @@ namespace uCSV
 	template<typename ContainerType>
 	[[nodiscard]] string_t escapeToStr(ContainerType const& container)
 	{
-		using std::begin, std::end;
-		return escapeToStr(begin(container), end(container));
+		if constexpr(Detail::IsCharRange<ContainerType>::value)
+		{
+			string_t result(escapedSize(container), '\0');
+			Detail::escape(Detail::charRange(container), result.data());
+			return result;
+		}
+		else
+		{
+			using std::begin, std::end;
+			return escapeToStr(begin(container), end(container));
+		}
 	}
 
 	// TODO: unescape
 
 	inline constexpr std::true_type readHeader;
 	inline constexpr std::false_type ignoreHeader;
+	// for Reader::reset: the new input starts with the same header as the previous one
+	struct KeepHeader {};
+	inline constexpr KeepHeader keepHeader;
+	// for Reader::reset: the new input starts with a header which is compared to the previous one
+	struct VerifyHeader {};
+	inline constexpr VerifyHeader verifyHeader;
 
-	template<
-		typename InputIteratorBeginT,
-		typename ErrorHandlerT = ErrorIgnore,
-		typename DelimiterMatcherT = DefaultDelimiter,
-		typename InputIteratorEndT = InputIteratorBeginT
-	>
-	class Reader
+	// what to do with a leading UTF-8 byte order mark
+	enum class Bom
 	{
-	public:
-		using InputIteratorBeginType = InputIteratorBeginT;
-		using InputIteratorEndType = InputIteratorEndT;
-		using ErrorHandlerType = ErrorHandlerT;
-		using DelimiterMatcherType = DelimiterMatcherT;
-		using HeaderType = std::vector<string_t>;
+		keep,
+		strip,
+	};
+	// the input is passed through byte by byte without any checks
+	struct RawEncoding
+	{
+		static constexpr Bom bom = Bom::keep;
+		static constexpr bool validate = false;
+	};
+	// invalid UTF-8 sequences are reported through raiseBadEncoding and the row is rejected
+	template<Bom bomPolicy = Bom::strip, bool doValidate = true>
+	struct Utf8
+	{
+		static constexpr Bom bom = bomPolicy;
+		static constexpr bool validate = doValidate;
+	};
 
-		template<bool doReadHeader>
-		constexpr Reader(InputIteratorBeginType begin, InputIteratorEndType end, std::bool_constant<doReadHeader>)
-			: mBegin(begin), mEnd(end)
+	enum class Escape
+	{
+		doubled, // "a""b"
+		backslash, // "a\"b" and a\,b; a backslash escapes any character, within quotes or not
+	};
+	// the syntax of the input. quote and comment may be '\0' to disable quoting and comments respectively. comment lines
+	// start with the comment character and are skipped as a whole. trimming removes spaces and tabs around the cells, but
+	// not within quotes
+	template<char_t quoteChar = '"', Escape escapeStyle = Escape::doubled, char_t commentChar = '\0', bool doTrim = false>
+	struct Dialect
+	{
+		static_assert(!isNewline(quoteChar) && !isNewline(commentChar), "newlines may not be quote or comment characters");
+		static_assert(quoteChar == '\0' || quoteChar != commentChar, "the quote and the comment characters have to differ");
+
+		static constexpr char_t quote = quoteChar;
+		static constexpr Escape escape = escapeStyle;
+		static constexpr char_t comment = commentChar;
+		static constexpr bool trim = doTrim;
+	};
+	using DefaultDialect = Dialect<>;
+
+	namespace Detail
+	{
+		// incremental UTF-8 validation; rejects overlong encodings, surrogates and code points beyond U+10FFFF
+		class Utf8Validator
 		{
+		public:
+			constexpr bool feed(char_t c) noexcept
+			{
+				const auto byte = static_cast<unsigned char>(c);
+				if(mRemaining == 0)
+				{
+					if(byte < 0x80)
+						return true;
+					if(byte < 0xC2)
+						return false;
+					mLow = 0x80;
+					mHigh = 0xBF;
+					if(byte < 0xE0)
+						mRemaining = 1;
+					else if(byte < 0xF0)
+					{
+						mRemaining = 2;
+						if(byte == 0xE0)
+							mLow = 0xA0;
+						else if(byte == 0xED)
+							mHigh = 0x9F;
+					}
+					else if(byte < 0xF5)
+					{
+						mRemaining = 3;
+						if(byte == 0xF0)
+							mLow = 0x90;
+						else if(byte == 0xF4)
+							mHigh = 0x8F;
+					}
+					else
+						return false;
+					return true;
+				}
+				if(byte < mLow || byte > mHigh)
+				{
+					mRemaining = 0;
+					return false;
+				}
+				mLow = 0x80;
+				mHigh = 0xBF;
+				--mRemaining;
+				return true;
+			}
+			[[nodiscard]] constexpr bool complete() const noexcept
+			{
+				return mRemaining == 0;
+			}
+			constexpr void reset() noexcept
+			{
+				mRemaining = 0;
+			}
+
+		private:
+			unsigned char mRemaining = 0;
+			unsigned char mLow = 0x80;
+			unsigned char mHigh = 0xBF;
+		};
+	}
+
+	// the end of a RowRange
+	struct RowRangeEnd
+	{
+	};
+
+	// the rows of a reader deserialized into RowT, read lazily while iterating. bad rows are skipped. the
+	// range is single pass: the current row lives in the range and is deserialized into again for every row, which reuses
+	// its buffers; it may be moved out of through the iterator. with C++20, the range is a std::ranges::view
+	template<typename ReaderT, typename RowT>
+	class RowRange
+#if defined(__cpp_lib_ranges)
+		: public std::ranges::view_base
+#endif
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = RowT;
+			using pointer = RowT*;
+			using reference = RowT&;
+
+			Iterator() = default;
+			explicit Iterator(RowRange& range) noexcept
+				: mRange(&range)
+			{
+			}
+
+			[[nodiscard]] RowT& operator*() const noexcept
+			{
+				return *mRange->mRow;
+			}
+			[[nodiscard]] RowT* operator->() const noexcept
+			{
+				return &*mRange->mRow;
+			}
+			Iterator& operator++()
+			{
+				mRange->next();
+				return *this;
+			}
+			void operator++(int)
+			{
+				++*this;
+			}
+
+			[[nodiscard]] friend bool operator==(Iterator const& iterator, RowRangeEnd) noexcept
+			{
+				return iterator.finished();
+			}
+			[[nodiscard]] friend bool operator==(RowRangeEnd end, Iterator const& iterator) noexcept
+			{
+				return iterator == end;
+			}
+			[[nodiscard]] friend bool operator!=(Iterator const& iterator, RowRangeEnd end) noexcept
+			{
+				return !(iterator == end);
+			}
+			[[nodiscard]] friend bool operator!=(RowRangeEnd end, Iterator const& iterator) noexcept
+			{
+				return !(iterator == end);
+			}
+
+		private:
+			RowRange* mRange = nullptr;
+
+			[[nodiscard]] bool finished() const noexcept
+			{
+				return !mRange->mRow;
+			}
+		};
+
+		RowRange() = default;
+		explicit RowRange(ReaderT& reader)
+			: mReader(&reader)
+		{
+		}
+
+		// fetches the first row; may only be called once
+		[[nodiscard]] Iterator begin()
+		{
+			mRow.emplace();
+			next();
+			return Iterator(*this);
+		}
+		[[nodiscard]] constexpr RowRangeEnd end() const noexcept
+		{
+			return {};
+		}
+
+	private:
+		ReaderT* mReader = nullptr;
+		std::optional<RowT> mRow; // empty at the end
+
+		void next()
+		{
+			while(!mReader->done())
+				if(mReader->fetch(*mRow))
+					return;
+			mRow.reset();
+		}
+	};
+
+	template<
+		typename InputIteratorBeginT,
+		typename ErrorHandlerT = ErrorIgnore,
+		typename DelimiterMatcherT = DefaultDelimiter,
+		typename InputIteratorEndT = InputIteratorBeginT,
+		typename EncodingT = RawEncoding,
+		typename DialectT = DefaultDialect,
+		typename AllocatorT = std::allocator<char_t>
+	>
+	class Reader
+	{
+	public:
+		using InputIteratorBeginType = InputIteratorBeginT;
+		using InputIteratorEndType = InputIteratorEndT;
+		using ErrorHandlerType = ErrorHandlerT;
+		using DelimiterMatcherType = DelimiterMatcherT;
+		using EncodingType = EncodingT;
+		using DialectType = DialectT;
+		// allocates the buffers of the current row. the header isn't part of the steady state and always uses std::allocator
+		using AllocatorType = AllocatorT;
+		using HeaderType = std::vector<string_t>;
+		// receives oversized cells in chunks, see streamCells
+		using CellSink = std::function<void(std::size_t row, std::size_t column, string_view_t chunk, bool last)>;
+		// sees the cells of every row, see observeRows
+		using RowObserver = std::function<void(string_view_t const* cells, std::size_t columns)>;
+
+		template<bool doReadHeader>
+		constexpr Reader(InputIteratorBeginType begin, InputIteratorEndType end, std::bool_constant<doReadHeader>)
+			: mBegin(begin), mEnd(end)
+		{
+			start();
 			if constexpr(doReadHeader)
 				readHeader();
 		}
@@ -400,6 +1307,7 @@ namespace uCSV
 		constexpr Reader(InputIteratorBeginType begin, InputIteratorEndType end, ErrorHandlerType errorHandler, std::bool_constant<doReadHeader>)
 			: mBegin(begin), mEnd(end), mErrorHandler(std::move(errorHandler))
 		{
+			start();
 			if constexpr(doReadHeader)
 				readHeader();
 		}
@@ -407,6 +1315,26 @@ namespace uCSV
 		constexpr Reader(InputIteratorBeginType begin, InputIteratorEndType end, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, std::bool_constant<doReadHeader>)
 			: mBegin(begin), mEnd(end), mErrorHandler(std::move(errorHandler)), mDelimiterMatcher(std::move(delimiterMatcher))
 		{
+			start();
+			if constexpr(doReadHeader)
+				readHeader();
+		}
+		template<bool doReadHeader>
+		constexpr Reader(InputIteratorBeginType begin, InputIteratorEndType end, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, EncodingType, std::bool_constant<doReadHeader> constant)
+			: Reader(std::move(begin), std::move(end), std::move(errorHandler), std::move(delimiterMatcher), constant)
+		{
+		}
+		template<bool doReadHeader>
+		constexpr Reader(InputIteratorBeginType begin, InputIteratorEndType end, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, EncodingType, DialectType, std::bool_constant<doReadHeader> constant)
+			: Reader(std::move(begin), std::move(end), std::move(errorHandler), std::move(delimiterMatcher), constant)
+		{
+		}
+		template<bool doReadHeader>
+		constexpr Reader(InputIteratorBeginType begin, InputIteratorEndType end, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, EncodingType, DialectType, AllocatorType const& allocator, std::bool_constant<doReadHeader>)
+			: mBegin(begin), mEnd(end), mErrorHandler(std::move(errorHandler)), mDelimiterMatcher(std::move(delimiterMatcher)),
+			mRow(allocator), mRowCells(RebindAllocator<string_view_t>(allocator)), mCellEnds(RebindAllocator<std::size_t>(allocator))
+		{
+			start();
 			if constexpr(doReadHeader)
 				readHeader();
 		}
@@ -426,6 +1354,21 @@ namespace uCSV
 			: Reader(std::istreambuf_iterator<char_t>(stream), std::istreambuf_iterator<char_t>(), std::move(errorHandler), std::move(delimiterMatcher), constant)
 		{
 		}
+		template<bool doReadHeader>
+		constexpr Reader(std::istream& stream, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, EncodingType encoding, std::bool_constant<doReadHeader> constant)
+			: Reader(std::istreambuf_iterator<char_t>(stream), std::istreambuf_iterator<char_t>(), std::move(errorHandler), std::move(delimiterMatcher), encoding, constant)
+		{
+		}
+		template<bool doReadHeader>
+		constexpr Reader(std::istream& stream, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, EncodingType encoding, DialectType dialect, std::bool_constant<doReadHeader> constant)
+			: Reader(std::istreambuf_iterator<char_t>(stream), std::istreambuf_iterator<char_t>(), std::move(errorHandler), std::move(delimiterMatcher), encoding, dialect, constant)
+		{
+		}
+		template<bool doReadHeader>
+		constexpr Reader(std::istream& stream, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, EncodingType encoding, DialectType dialect, AllocatorType const& allocator, std::bool_constant<doReadHeader> constant)
+			: Reader(std::istreambuf_iterator<char_t>(stream), std::istreambuf_iterator<char_t>(), std::move(errorHandler), std::move(delimiterMatcher), encoding, dialect, allocator, constant)
+		{
+		}
 
 		[[nodiscard]] constexpr ErrorHandlerType const& errorHandler() const noexcept
 		{
@@ -443,6 +1386,37 @@ namespace uCSV
 		{
 			return mDelimiterMatcher;
 		}
+		[[nodiscard]] AllocatorType allocator() const
+		{
+			return mRow.get_allocator();
+		}
+
+		// a record exceeding one of the limits is reported through raiseLimitExceeded of the error handler (or raiseBadCell if
+		// it has none) and skipped up to the next line break, so that the memory held by the reader stays bounded. the
+		// header is read by the constructor; to bound it as well, construct with ignoreHeader, set the limits and then reset
+		// with readHeader
+		void limits(Limits const& limits) noexcept
+		{
+			mLimits = limits;
+		}
+		[[nodiscard]] constexpr Limits const& limits() const noexcept
+		{
+			return mLimits;
+		}
+		// instead of being reported, cells longer than limits().cellBytes are handed to sink in chunks of at most that size,
+		// the last one with last set, and are empty within the fetched row. a record that turns out bad afterwards is
+		// skipped as usual, in which case its streamed cell ends without a last chunk. an empty sink turns streaming off
+		void streamCells(CellSink sink)
+		{
+			mCellSink = std::move(sink);
+		}
+		// observer is called with the cells of every row that is fetched or discarded successfully, before it is
+		// deserialized, e.g. by ColumnProfiler. headers, including those read by reset, aren't rows and aren't observed.
+		// the cells are only valid during the call. an empty observer detaches it
+		void observeRows(RowObserver observer)
+		{
+			mRowObserver = std::move(observer);
+		}
 
 		// returns 0 before the first sucessful fetch operation
 		[[nodiscard]] constexpr std::size_t columns() const noexcept
@@ -464,7 +1438,7 @@ namespace uCSV
 
 		[[nodiscard]] constexpr bool done() const noexcept
 		{
-			return mBegin == mEnd;
+			return atEnd();
 		}
 
 		// number of rows fetched thus far, including the header row (if present)
@@ -472,6 +1446,67 @@ namespace uCSV
 		{
 			return mRows;
 		}
+		// hash of the cells of the row fetched last. it depends on the cell contents and boundaries, but not on quoting
+		[[nodiscard]] std::uint64_t rowHash() const noexcept
+		{
+			const std::uint64_t cells = uCSV::hash(mRow.data(), mRow.size());
+			return uCSV::hash(mCellEnds.data(), mCellEnds.size() * sizeof(std::size_t), cells);
+		}
+		// the start of the next record
+		[[nodiscard]] constexpr InputIteratorBeginType const& position() const noexcept
+		{
+			return mBegin;
+		}
+		[[nodiscard]] constexpr InputIteratorEndType const& endPosition() const noexcept
+		{
+			return mEnd;
+		}
+		// continues at position, which has to be the start of a record, e.g. one returned by position(). unlike reset, the
+		// header and the number of columns are kept, but rows() no longer counts the records before position
+		void seek(InputIteratorBeginType position)
+		{
+			static_assert(!usesReplay, "single pass iterators can't seek");
+			mBegin = std::move(position);
+		}
+		// continues with another input. the buffers and the error handler are kept, everything else starts over
+		template<bool doReadHeader>
+		void reset(InputIteratorBeginType begin, InputIteratorEndType end, std::bool_constant<doReadHeader>)
+		{
+			rebind(std::move(begin), std::move(end));
+			mColumns = 0;
+			mHeader.clear();
+			if constexpr(doReadHeader)
+				readHeader();
+		}
+		// the header line of the new input is skipped without being parsed
+		void reset(InputIteratorBeginType begin, InputIteratorEndType end, KeepHeader)
+		{
+			rebind(std::move(begin), std::move(end));
+			if(hasHeader())
+			{
+				skipRecord();
+				skipComments();
+				++mRows;
+			}
+		}
+		// returns false if the header of the new input differs from the previous one, which is replaced in that case
+		bool reset(InputIteratorBeginType begin, InputIteratorEndType end, VerifyHeader)
+		{
+			rebind(std::move(begin), std::move(end));
+			// the new header may have any number of columns
+			mColumns = 0;
+			const bool read = fetchHeader(mHeaderScratch);
+			const bool matches = read && mHeaderScratch == mHeader;
+			if(!matches)
+			{
+				if(read)
+					mHeader.swap(mHeaderScratch);
+				else
+					mHeader.clear();
+			}
+			return matches;
+		}
+
 		bool discard()
 		{
 			return skipLine();
@@ -508,30 +1543,63 @@ namespace uCSV
 		OutputIteratorT fetch(OutputIteratorT first, OutputIterator2T last)
 		{
 			using ValueT = iterator_value_t<OutputIteratorT>;
-			for(ValueT value; mBegin != mEnd && first != last && fetch(value); *first = value, ++first);
+			for(ValueT value; !done() && first != last && fetch(value); *first = std::move(value), ++first);
 			return first;
 		}
 		template<typename OutputIteratorT>
 		OutputIteratorT fetchN(OutputIteratorT first, std::size_t n)
 		{
 			using ValueT = iterator_value_t<OutputIteratorT>;
-			for(ValueT value; n-- && mBegin != mEnd && fetch(value); *first = value, ++first);
+			for(ValueT value; n-- && !done() && fetch(value); *first = std::move(value), ++first);
 			return first;
 		}
 		template<typename OutputIteratorT, typename OutputIterator2T>
 		OutputIteratorT fetchN(OutputIteratorT first, OutputIterator2T last, std::size_t n)
 		{
 			using ValueT = iterator_value_t<OutputIteratorT>;
-			for(ValueT value; n-- && mBegin != mEnd && first != last && fetch(value); *first = value, ++first);
+			for(ValueT value; n-- && !done() && first != last && fetch(value); *first = std::move(value), ++first);
 			return first;
 		}
 		template<typename OutputIteratorT>
 		OutputIteratorT fetchAll(OutputIteratorT out)
 		{
 			using ValueT = iterator_value_t<OutputIteratorT>;
-			for(ValueT value; mBegin != mEnd && fetch(value); *out = value, ++out);
+			for(ValueT value; !done() && fetch(value); *out = std::move(value), ++out);
 			return out;
 		}
+		// constructs every remaining row in place at the back of container, e.g. a std::vector or std::deque, so that its
+		// buffers are allocated once and never copied. the rows of a std::pmr container are constructed with its
+		// allocator, hence with a std::pmr::monotonic_buffer_resource all cells of a bulk load end up in its chunks. unlike
+		// fetchAll, it skips bad rows instead of stopping at them. returns the number of rows appended
+		template<typename ContainerT>
+		std::size_t emplaceAll(ContainerT& container)
+		{
+			std::size_t appended = 0;
+			while(!done())
+			{
+				if(!readLine())
+					continue;
+				Deserializer deserializer(columns(), mHeader.data(), mRowCells.data());
+				container.emplace_back();
+				try
+				{
+					deserialize(deserializer, container.back());
+				}
+				catch(...)
+				{
+					container.pop_back();
+					throw;
+				}
+				++appended;
+			}
+			return appended;
+		}
+		// the remaining rows as a single pass input range, see RowRange
+		template<typename RowT>
+		[[nodiscard]] RowRange<Reader, RowT> rows()
+		{
+			return RowRange<Reader, RowT>(*this);
+		}
 
 	private:
 		InputIteratorBeginType mBegin;
@@ -542,13 +1610,213 @@ namespace uCSV
 		std::size_t mRows = 0;
 		std::size_t mColumns = 0;
 		HeaderType mHeader;
+		HeaderType mHeaderScratch;
+
+		template<typename T>
+		using RebindAllocator = typename std::allocator_traits<AllocatorType>::template rebind_alloc<T>;
+
+		// these only ever grow, so that fetching allocates nothing once they fit the longest row
+		/*mutable*/ std::basic_string<char_t, std::char_traits<char_t>, RebindAllocator<char_t>> mRow;
+		/*mutable*/ std::vector<string_view_t, RebindAllocator<string_view_t>> mRowCells;
+		/*mutable*/ std::vector<std::size_t, RebindAllocator<std::size_t>> mCellEnds;
+
+		Limits mLimits;
+		CellSink mCellSink;
+		RowObserver mRowObserver;
+		bool mReadingHeader = false; // the header isn't a row, hence it isn't observed
+		std::size_t mBudget = ~std::size_t(0);
+		std::size_t mCellStart = 0;
+		std::size_t mFlushed = 0; // bytes of the current cell already handed to mCellSink
+		bool mStreaming = false;
+		bool mLimitExceeded = false;
+
+		// single pass iterators can't look ahead, so the bytes of a partially matched byte order mark have to be replayed
+		static constexpr bool usesReplay = EncodingType::bom == Bom::strip
+			&& !std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIteratorBeginType>::iterator_category>;
+		char_t mReplay[2] = {};
+		unsigned char mReplayBegin = 0;
+		unsigned char mReplayEnd = 0;
+
+		Detail::Utf8Validator mValidator;
+		bool mBadEncoding = false;
 
-		/*mutable*/ string_t mRow;
-		/*mutable*/ std::vector<string_view_t> mRowCells;
+		static constexpr bool quoting = DialectType::quote != '\0';
+		static constexpr bool backslash = DialectType::escape == Escape::backslash;
+
+		[[nodiscard]] static constexpr bool isQuote(char_t c) noexcept
+		{
+			if constexpr(quoting)
+				return c == DialectType::quote;
+			else
+				return false;
+		}
+		[[nodiscard]] static constexpr bool isBlank(char_t c) noexcept
+		{
+			return c == ' ' || c == '\t';
+		}
+		// skips spaces and tabs if the dialect trims; returns false if the input ends with them
+		bool skipBlanks(char_t& read)
+		{
+			if constexpr(DialectType::trim)
+			{
+				while(isBlank(read))
+				{
+					if(atEnd())
+						return false;
+					read = get();
+				}
+			}
+			return true;
+		}
+
+		[[nodiscard]] constexpr bool atEnd() const
+		{
+			if constexpr(usesReplay)
+				if(mReplayBegin != mReplayEnd)
+					return false;
+			return mBegin == mEnd;
+		}
+		[[nodiscard]] constexpr char_t peek() const
+		{
+			if constexpr(usesReplay)
+				if(mReplayBegin != mReplayEnd)
+					return mReplay[mReplayBegin];
+			return *mBegin;
+		}
+		// all input passes through here, which lets the validation share the scanning loop
+		constexpr char_t get()
+		{
+			char_t result;
+			if constexpr(usesReplay)
+			{
+				if(mReplayBegin != mReplayEnd)
+					result = mReplay[mReplayBegin++];
+				else
+					result = *mBegin++;
+			}
+			else
+				result = *mBegin++;
+			if constexpr(EncodingType::validate)
+				if(!mValidator.feed(result))
+					mBadEncoding = true;
+			return result;
+		}
+		void skipBom()
+		{
+			if constexpr(EncodingType::bom == Bom::strip)
+			{
+				constexpr unsigned char bom[] = { 0xEF, 0xBB, 0xBF };
+				if constexpr(usesReplay)
+				{
+					std::size_t matched = 0;
+					for(; matched < 3 && mBegin != mEnd && static_cast<unsigned char>(*mBegin) == bom[matched]; ++matched)
+						++mBegin;
+					if(matched < 3)
+					{
+						for(std::size_t i = 0; i < matched; ++i)
+							mReplay[i] = static_cast<char_t>(bom[i]);
+						mReplayEnd = static_cast<unsigned char>(matched);
+					}
+				}
+				else
+				{
+					InputIteratorBeginType it = mBegin;
+					for(unsigned char const byte : bom)
+					{
+						if(it == mEnd || static_cast<unsigned char>(*it) != byte)
+							return;
+						++it;
+					}
+					mBegin = it;
+				}
+			}
+		}
 
 		void readHeader()
 		{
-			fetch(mHeader);
+			fetchHeader(mHeader);
+		}
+		bool fetchHeader(HeaderType& header)
+		{
+			mReadingHeader = true;
+			try
+			{
+				const bool read = fetch(header);
+				mReadingHeader = false;
+				return read;
+			}
+			catch(...)
+			{
+				mReadingHeader = false;
+				throw;
+			}
+		}
+
+		// the quote character may be a delimiter in other dialects, but not in this one
+		static_assert(!quoting || !Detail::StaticDelimiter<DelimiterMatcherType>::matches(DialectType::quote), "the dialect's quote character may not be a delimitor");
+		static_assert(DialectType::comment == '\0' || !Detail::StaticDelimiter<DelimiterMatcherType>::matches(DialectType::comment), "the dialect's comment character may not be a delimitor");
+
+		void start()
+		{
+			if constexpr(!Detail::StaticDelimiter<DelimiterMatcherType>::known)
+			{
+				if constexpr(quoting)
+					if(mDelimiterMatcher(DialectType::quote))
+						throw std::invalid_argument("uCSV::Reader: the dialect's quote character may not be a delimitor");
+				if constexpr(DialectType::comment != '\0')
+					if(mDelimiterMatcher(DialectType::comment))
+						throw std::invalid_argument("uCSV::Reader: the dialect's comment character may not be a delimitor");
+			}
+			skipBom();
+			skipComments();
+		}
+		// comments are skipped right after every record, so that done() is accurate
+		void skipComments()
+		{
+			if constexpr(DialectType::comment != '\0')
+			{
+				while(!atEnd() && peek() == DialectType::comment)
+				{
+					char_t read;
+					do
+						read = get();
+					while(!isNewline(read) && !atEnd());
+					if(read == '\r' && !atEnd() && peek() == '\n')
+						get();
+				}
+			}
+		}
+
+		void rebind(InputIteratorBeginType begin, InputIteratorEndType end)
+		{
+			mBegin = std::move(begin);
+			mEnd = std::move(end);
+			mRows = 0;
+			mReplayBegin = 0;
+			mReplayEnd = 0;
+			start();
+		}
+		// skips a record without parsing or validating it
+		void skipRecord()
+		{
+			if(atEnd())
+				return;
+			char_t read = get();
+			if(!isNewline(read))
+			{
+				for(bool continues = true; continues;)
+				{
+					skipCell(read, continues);
+					if(continues)
+					{
+						if(atEnd())
+							break;
+						read = get();
+					}
+				}
+			}
+			if(read == '\r' && !atEnd() && peek() == '\n')
+				get();
 		}
 
 		// TODO: add an additional fast implementations of all this read... crap for contiguous iterators
@@ -556,22 +1824,36 @@ namespace uCSV
 		void skipCell(char_t& read, bool& continues)
 		{
 			continues = false;
-			if(read == '"')
+			if(!skipBlanks(read))
+				return;
+			if(isQuote(read))
 			{
 				for(;;)
 				{
-					if(mBegin == mEnd)
+					if(atEnd())
 						return;
-					read = *mBegin++;
-					if(read == '"')
+					read = get();
+					if constexpr(backslash)
+					{
+						if(read == '\\')
+						{
+							if(atEnd())
+								return;
+							get();
+							continue;
+						}
+					}
+					if(isQuote(read))
 					{
-						if(mBegin == mEnd)
+						if(atEnd())
 							break;
-						read = *mBegin++;
+						read = get();
+						if(!skipBlanks(read))
+							return;
 						continues = mDelimiterMatcher(constify(read));
 						if(continues || isNewline(read))
 							break;
-						else if(read != '"')
+						else if(backslash || !isQuote(read))
 							return skipCell(read, continues);
 					}
 				}
@@ -580,51 +1862,104 @@ namespace uCSV
 			{
 				for(;;)
 				{
+					if constexpr(backslash)
+					{
+						if(read == '\\')
+						{
+							if(atEnd())
+								break;
+							get();
+							if(atEnd())
+								break;
+							read = get();
+							continue;
+						}
+					}
 					continues = mDelimiterMatcher(constify(read));
 					if(continues || isNewline(read))
 						break;
-					if(mBegin == mEnd)
+					if(atEnd())
 						break;
-					read = *mBegin++;
+					read = get();
 				}
 			}
 		}
 		bool readCell(char_t& read, std::size_t& columns, bool& continues)
 		{
 			continues = false;
-			if(read == '"')
+			startCell();
+			if(!skipBlanks(read))
+				return true;
+			if(isQuote(read))
 			{
 				for(;;)
 				{
-					if(mBegin == mEnd)
+					if(atEnd())
 					{
 						mErrorHandler.raiseUnexpectedEnd(constify(mRows));
 						return false;
 					}
-					read = *mBegin++;
-					if(read == '"')
+					read = get();
+					if constexpr(backslash)
 					{
-						if(mBegin == mEnd)
+						if(read == '\\')
+						{
+							if(atEnd())
+							{
+								mErrorHandler.raiseUnexpectedEnd(constify(mRows));
+								return false;
+							}
+							if(!push(get(), columns - 1))
+								return false;
+							continue;
+						}
+					}
+					if(isQuote(read))
+					{
+						if(atEnd())
+							break;
+						read = get();
+						if(!skipBlanks(read))
 							break;
-						read = *mBegin++;
 						continues = mDelimiterMatcher(constify(read));
 						if(continues || isNewline(read))
 							break;
-						else if(read != '"')
+						else if(backslash || !isQuote(read))
 						{
 							skipCell(read, continues);
 							mErrorHandler.raiseBadCell(columns - 1, constify(mRows));
 							return false;
 						}
 					}
-					mRow.push_back(read);
+					if(!push(read, columns - 1))
+						return false;
 				}
 			}
 			else
 			{
+				// escaped blanks are kept when trimming. counted from the start of the cell since streaming flushes mRow
+				[[maybe_unused]] std::size_t kept = 0;
 				for(;;)
 				{
-					if(read == '"')
+					if constexpr(backslash)
+					{
+						if(read == '\\')
+						{
+							if(atEnd())
+							{
+								mErrorHandler.raiseUnexpectedEnd(constify(mRows));
+								return false;
+							}
+							if(!push(get(), columns - 1))
+								return false;
+							kept = cellBytes();
+							if(atEnd())
+								break;
+							read = get();
+							continue;
+						}
+					}
+					if(isQuote(read))
 					{
 						skipCell(read, continues);
 						mErrorHandler.raiseBadCell(columns - 1, constify(mRows));
@@ -633,44 +1968,117 @@ namespace uCSV
 					continues = mDelimiterMatcher(constify(read));
 					if(continues || isNewline(read))
 						break;
-					mRow.push_back(read);
-					if(mBegin == mEnd)
+					if(!push(read, columns - 1))
+						return false;
+					if(atEnd())
 						break;
-					read = *mBegin++;
+					read = get();
 				}
+				if constexpr(DialectType::trim)
+					while(cellBytes() > kept && mRow.size() > mCellStart && isBlank(mRow.back()))
+						mRow.pop_back();
 			}
+			endCell(columns - 1);
 			if(continues)
-			{
-				const bool last = (mColumns != 0 && columns >= mColumns);
-				if(!last)
-					mRow.push_back(read);
 				++columns;
+			return true;
+		}
+
+		// every byte of a cell is appended through push, which enforces the limits. mBudget is the size mRow may grow to
+		// before one of them is reached, so that the common case costs a single comparison
+		void startCell() noexcept
+		{
+			mCellStart = mRow.size();
+			mFlushed = 0;
+			mStreaming = false;
+			const std::size_t cellEnd = mCellStart + std::min(mLimits.cellBytes, ~std::size_t(0) - mCellStart);
+			mBudget = std::min(cellEnd, mLimits.rowBytes);
+		}
+		[[nodiscard]] std::size_t cellBytes() const noexcept
+		{
+			return mFlushed + (mRow.size() - mCellStart);
+		}
+		bool push(char_t c, std::size_t column)
+		{
+			if(mRow.size() >= mBudget)
+			{
+				if(!mCellSink || mRow.size() - mCellStart < mLimits.cellBytes)
+				{
+					raiseLimit(mRow.size() - mCellStart < mLimits.cellBytes ? Limit::rowBytes : Limit::cellBytes, column);
+					return false;
+				}
+				// hand the cell over in chunks of cellBytes instead of buffering it
+				mCellSink(constify(mRows), constify(column), string_view_t(mRow.data() + mCellStart, mRow.size() - mCellStart), false);
+				mFlushed += mRow.size() - mCellStart;
+				mRow.resize(mCellStart);
+				mStreaming = true;
 			}
+			mRow.push_back(c);
 			return true;
 		}
+		// the final chunk of a streamed cell, whose value within the row is empty
+		void endCell(std::size_t column)
+		{
+			if(!mStreaming)
+				return;
+			mCellSink(constify(mRows), constify(column), string_view_t(mRow.data() + mCellStart, mRow.size() - mCellStart), true);
+			mRow.resize(mCellStart);
+			mStreaming = false;
+		}
+		void raiseLimit(Limit limit, std::size_t column)
+		{
+			if constexpr(Detail::HasLimitHook<ErrorHandlerType>::value)
+				mErrorHandler.raiseLimitExceeded(limit, static_cast<unsigned int>(column), constify(mRows));
+			else
+				mErrorHandler.raiseBadCell(static_cast<unsigned int>(column), constify(mRows));
+			mLimitExceeded = true;
+		}
+		// after a limit has been exceeded, quotes can't be trusted anymore: a single unterminated one would make the rest
+		// of the input one cell. hence the remainder of the record is skipped up to the next line break, where the next
+		// record most likely starts
+		void resync(char_t read)
+		{
+			while(!isNewline(read) && !atEnd())
+				read = get();
+			if(read == '\r' && !atEnd() && peek() == '\n')
+				get();
+		}
 		bool skipLine()
 		{
 			// TODO: can be optimized; dont store the line and dont store the views
 			return readLine();
 		}
 		bool readLine()
+		{
+			const bool result = readRecord();
+			skipComments();
+			return result;
+		}
+		bool readRecord()
 		{
 			mRow.clear();
 			mRowCells.clear();
+			mCellEnds.clear();
+			if constexpr(EncodingType::validate)
+			{
+				mValidator.reset();
+				mBadEncoding = false;
+			}
 
-			if(mBegin == mEnd)
+			if(atEnd())
 			{
 				mErrorHandler.raiseUnexpectedEnd(constify(mRows));
 				return false;
 			}
 
 			std::size_t columns = 1;
-			char_t read = *mBegin++;
+			std::optional<std::size_t> badEncodingColumn;
+			char_t read = get();
 
 			if(isNewline(read))
 			{
-				if(read == '\r' && mBegin != mEnd && *mBegin == '\n')
-					++mBegin;
+				if(read == '\r' && !atEnd() && peek() == '\n')
+					get();
 				mErrorHandler.raiseIncorrectColumns(0, mColumns > 0 ? mColumns : 1, constify(mRows));
 				return false;
 			}
@@ -678,7 +2086,17 @@ namespace uCSV
 			for(;;)
 			{
 				bool continues;
+				const std::size_t column = columns - 1;
 				const bool badCell = !readCell(read, columns, continues);
+				if(mLimitExceeded)
+				{
+					mLimitExceeded = false;
+					resync(read);
+					return false;
+				}
+				if constexpr(EncodingType::validate)
+					if(mBadEncoding && !badEncodingColumn)
+						badEncodingColumn = column;
 				if(!continues)
 				{
 					if(badCell)
@@ -687,45 +2105,53 @@ namespace uCSV
 						break;
 				}
 
+				if(columns > mLimits.columns || mRow.size() >= mLimits.rowBytes)
+				{
+					// the rest of the record is skipped without being stored
+					raiseLimit(columns > mLimits.columns ? Limit::columns : Limit::rowBytes, columns - 1);
+					mLimitExceeded = false;
+					resync(read);
+					return false;
+				}
 				if(badCell || (mColumns != 0 && columns > mColumns))
 				{
 					assert(mDelimiterMatcher(read));
 					std::size_t excess = 0;
-					if(mBegin == mEnd)
+					if(atEnd())
 						excess = 1;
 					else
 						for(bool continues;;)
 						{
-							read = *mBegin++;
+							read = get();
 							skipCell(read, continues);
 							++excess;
 							if(!continues)
 								break;
 						}
-					if(read == '\r' && mBegin != mEnd && *mBegin == '\n')
-						++mBegin;
+					if(read == '\r' && !atEnd() && peek() == '\n')
+						get();
 					const std::size_t realColumns = columns - 1 + excess;
 					if(realColumns != mColumns)
 						mErrorHandler.raiseIncorrectColumns(realColumns, constify(mColumns), constify(mRows));
 					return false;
 				}
 
-				read = *mBegin++;
+				// the delimiter is kept in mRow so that every cell is terminated by a non-numeric character
+				mCellEnds.push_back(mRow.size());
+				mRow.push_back(read);
+				if(atEnd())
+					break; // a delimiter at the very end of the input is followed by an empty cell
+				read = get();
 			}
-			if(read == '\r' && mBegin != mEnd && *mBegin == '\n')
-				++mBegin;
+			if(read == '\r' && !atEnd() && peek() == '\n')
+				get();
 
-			// TODO: do this more cleverly. the idea is to store views to the data as it is being procesed (by readCell).
-			// the hard part is that we have to also store an mRowCells pointers so that we know which ones to recompute
-			// later on due to reallocation
+			// the views can only be created once the row is complete since mRow may reallocate while it is being read
 			std::size_t last = 0;
-			for(std::size_t i = 0; i < mRow.size() && mRowCells.size() < columns - 1; ++i)
+			for(const std::size_t end : mCellEnds)
 			{
-				if(mDelimiterMatcher(constify(mRow[i])))
-				{
-					mRowCells.emplace_back(mRow.data() + last, i - last);
-					last = i + 1;
-				}
+				mRowCells.emplace_back(mRow.data() + last, end - last);
+				last = end + 1;
 			}
 			mRowCells.emplace_back(mRow.data() + last, mRow.size() - last);
 
@@ -737,6 +2163,23 @@ namespace uCSV
 				return false;
 			}
 
+			if constexpr(EncodingType::validate)
+			{
+				// the input may end within a multi-byte sequence
+				if(!mBadEncoding && !mValidator.complete())
+				{
+					mBadEncoding = true;
+					badEncodingColumn = columns - 1;
+				}
+				if(mBadEncoding)
+				{
+					mErrorHandler.raiseBadEncoding(static_cast<unsigned int>(*badEncodingColumn), constify(mRows));
+					return false;
+				}
+			}
+
+			if(mRowObserver && !mReadingHeader)
+				mRowObserver(mRowCells.data(), mRowCells.size());
 			++mRows;
 			return true;
 		}
@@ -786,6 +2229,107 @@ namespace uCSV
 			std::decay_t<U>
 		>
 	>;
+	template<typename T, typename U, typename V, typename W, bool doReadHeader>
+	Reader(T&&, U&&, V&&, W&&, std::bool_constant<doReadHeader>) -> Reader<
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::istreambuf_iterator<uCSV::char_t>,
+			std::decay_t<T>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<U>,
+			std::decay_t<V>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<V>,
+			std::decay_t<W>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::istreambuf_iterator<uCSV::char_t>,
+			std::decay_t<U>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<W>,
+			RawEncoding
+		>
+	>;
+	template<typename T, typename U, typename V, typename W, typename X, bool doReadHeader>
+	Reader(T&&, U&&, V&&, W&&, X&&, std::bool_constant<doReadHeader>) -> Reader<
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::istreambuf_iterator<uCSV::char_t>,
+			std::decay_t<T>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<U>,
+			std::decay_t<V>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<V>,
+			std::decay_t<W>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::istreambuf_iterator<uCSV::char_t>,
+			std::decay_t<U>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<W>,
+			std::decay_t<X>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<X>,
+			DefaultDialect
+		>
+	>;
+	template<typename T, typename U, typename V, typename W, typename X, typename Y, bool doReadHeader>
+	Reader(T&&, U&&, V&&, W&&, X&&, Y&&, std::bool_constant<doReadHeader>) -> Reader<
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::istreambuf_iterator<uCSV::char_t>,
+			std::decay_t<T>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<U>,
+			std::decay_t<V>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<V>,
+			std::decay_t<W>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::istreambuf_iterator<uCSV::char_t>,
+			std::decay_t<U>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<W>,
+			std::decay_t<X>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<X>,
+			std::decay_t<Y>
+		>,
+		std::conditional_t<
+			std::is_base_of_v<std::istream, std::decay_t<T>>,
+			std::decay_t<Y>,
+			std::allocator<uCSV::char_t>
+		>
+	>;
+	template<typename T, typename U, typename V, typename W, typename X, typename Y, typename Z, bool doReadHeader>
+	Reader(T&&, U&&, V&&, W&&, X&&, Y&&, Z&&, std::bool_constant<doReadHeader>) -> Reader<std::decay_t<T>, std::decay_t<V>, std::decay_t<W>, std::decay_t<U>, std::decay_t<X>, std::decay_t<Y>, std::decay_t<Z>>;
 }
 
 #endif // !UCSV_HPP_INCLUDED
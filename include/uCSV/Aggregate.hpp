@@ -0,0 +1,421 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_AGGREGATE_HPP_INCLUDED
+#define UCSV_AGGREGATE_HPP_INCLUDED
+
+#include <uCSV.hpp>
+#include <uCSV/Pipeline.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace uCSV
+{
+	enum class Aggregation
+	{
+		count, // cells which hold a number, like COUNT(column) in SQL
+		sum,
+		min,
+		max,
+		mean,
+	};
+
+	struct Aggregate
+	{
+		Aggregation function;
+		std::size_t column;
+	};
+	using Aggregates = std::vector<Aggregate>;
+
+	struct AggregateOptions
+	{
+		std::size_t threads = 0; // aggregating threads; 0 picks one less than the number of hardware threads, 1 aggregates on the calling thread
+		std::size_t batchRows = 4096; // rows per batch handed to an aggregating thread
+	};
+
+	struct AggregateGroup
+	{
+		string_t key;
+		std::size_t rows = 0;
+		std::vector<double> values; // one per aggregate; NaN for min, max and mean of groups without numbers
+	};
+
+	struct AggregateResult
+	{
+		std::vector<AggregateGroup> groups; // ordered by key
+		std::size_t rows = 0;
+		std::size_t invalidCells = 0; // cells of aggregated columns which don't hold a number and have been skipped
+	};
+
+	namespace Detail
+	{
+		struct AggregateState
+		{
+			double sum = 0;
+			double min = std::numeric_limits<double>::infinity();
+			double max = -std::numeric_limits<double>::infinity();
+			std::size_t count = 0;
+
+			void add(double value) noexcept
+			{
+				sum += value;
+				min = std::min(min, value);
+				max = std::max(max, value);
+				++count;
+			}
+			void merge(AggregateState const& other) noexcept
+			{
+				sum += other.sum;
+				min = std::min(min, other.min);
+				max = std::max(max, other.max);
+				count += other.count;
+			}
+			[[nodiscard]] double result(Aggregation function) const noexcept
+			{
+				constexpr double none = std::numeric_limits<double>::quiet_NaN();
+				switch(function)
+				{
+				case Aggregation::count:
+					return static_cast<double>(count);
+				case Aggregation::sum:
+					return sum;
+				case Aggregation::min:
+					return count > 0 ? min : none;
+				case Aggregation::max:
+					return count > 0 ? max : none;
+				case Aggregation::mean:
+					return count > 0 ? sum / static_cast<double>(count) : none;
+				}
+				return none;
+			}
+		};
+
+		// the distinct columns referenced by the aggregates, so that every cell is converted once
+		struct AggregatePlan
+		{
+			std::vector<std::size_t> columns;
+			std::vector<std::size_t> slots; // index into columns of every aggregate
+
+			explicit AggregatePlan(Aggregates const& aggregates)
+			{
+				for(Aggregate const& aggregate : aggregates)
+				{
+					const auto found = std::find(columns.begin(), columns.end(), aggregate.column);
+					slots.push_back(static_cast<std::size_t>(found - columns.begin()));
+					if(found == columns.end())
+						columns.push_back(aggregate.column);
+				}
+			}
+		};
+
+		// the partial aggregates of one thread, keyed by the bytes of the key cells. open addressing with linear probing;
+		// the keys live in a single buffer and the states of a group are consecutive
+		class AggregateTable
+		{
+		public:
+			explicit AggregateTable(AggregatePlan const& plan)
+				: mPlan(plan), mAggregates(plan.slots.size()), mValues(plan.columns.size()), mSlots(64, none)
+			{
+			}
+
+			// cells holds one cell per column of the plan, each followed by a character which can't continue a number
+			void add(string_view_t key, string_view_t const* cells)
+			{
+				for(std::size_t i = 0; i < mValues.size(); ++i)
+				{
+					if(cells[i].empty() || !convertCell(cells[i], mValues[i]))
+					{
+						mValues[i] = std::numeric_limits<double>::quiet_NaN();
+						++mInvalidCells;
+					}
+				}
+				const std::size_t index = find(key);
+				++mGroups[index].rows;
+				AggregateState* const states = mStates.data() + index * mAggregates;
+				for(std::size_t i = 0; i < mAggregates; ++i)
+				{
+					const double value = mValues[mPlan.slots[i]];
+					if(value == value)
+						states[i].add(value);
+				}
+			}
+			void merge(AggregateTable const& other)
+			{
+				for(std::size_t i = 0; i < other.mGroups.size(); ++i)
+				{
+					const std::size_t index = find(other.key(other.mGroups[i]));
+					mGroups[index].rows += other.mGroups[i].rows;
+					for(std::size_t j = 0; j < mAggregates; ++j)
+						mStates[index * mAggregates + j].merge(other.mStates[i * mAggregates + j]);
+				}
+				mInvalidCells += other.mInvalidCells;
+			}
+			void results(Aggregates const& aggregates, AggregateResult& result) const
+			{
+				result.groups.resize(mGroups.size());
+				for(std::size_t i = 0; i < mGroups.size(); ++i)
+				{
+					AggregateGroup& target = result.groups[i];
+					target.key = key(mGroups[i]);
+					target.rows = mGroups[i].rows;
+					result.rows += target.rows;
+					target.values.resize(mAggregates);
+					for(std::size_t j = 0; j < mAggregates; ++j)
+						target.values[j] = mStates[i * mAggregates + j].result(aggregates[j].function);
+				}
+				std::sort(result.groups.begin(), result.groups.end(), [](AggregateGroup const& lhs, AggregateGroup const& rhs) { return lhs.key < rhs.key; });
+				result.invalidCells = mInvalidCells;
+			}
+
+		private:
+			static constexpr std::size_t none = ~std::size_t(0);
+
+			struct Group
+			{
+				std::uint64_t hash;
+				std::size_t offset; // of the key in mKeys
+				std::size_t size;
+				std::size_t rows;
+			};
+
+			AggregatePlan const& mPlan;
+			std::size_t mAggregates;
+			std::vector<double> mValues; // of the current row, NaN for cells which don't hold a number
+			std::vector<std::size_t> mSlots; // indices of groups, or none; the size is a power of two
+			std::vector<Group> mGroups;
+			std::vector<AggregateState> mStates;
+			string_t mKeys;
+			std::size_t mInvalidCells = 0;
+
+			[[nodiscard]] string_view_t key(Group const& group) const noexcept
+			{
+				return string_view_t(mKeys.data() + group.offset, group.size);
+			}
+			// the index of the group of key, which is created if there is none
+			std::size_t find(string_view_t key)
+			{
+				const std::uint64_t hash = uCSV::hash(key);
+				const std::size_t mask = mSlots.size() - 1;
+				std::size_t slot = static_cast<std::size_t>(hash) & mask;
+				for(; mSlots[slot] != none; slot = (slot + 1) & mask)
+				{
+					Group const& candidate = mGroups[mSlots[slot]];
+					if(candidate.hash == hash && this->key(candidate) == key)
+						return mSlots[slot];
+				}
+
+				const std::size_t index = mGroups.size();
+				mSlots[slot] = index;
+				mGroups.push_back({ hash, mKeys.size(), key.size(), 0 });
+				mKeys.append(key.data(), key.size());
+				mStates.resize(mStates.size() + mAggregates);
+				if(mGroups.size() * 2 > mSlots.size())
+					grow();
+				return index;
+			}
+			void grow()
+			{
+				std::vector<std::size_t> slots(mSlots.size() * 2, none);
+				const std::size_t mask = slots.size() - 1;
+				for(std::size_t i = 0; i < mGroups.size(); ++i)
+				{
+					std::size_t slot = static_cast<std::size_t>(mGroups[i].hash) & mask;
+					while(slots[slot] != none)
+						slot = (slot + 1) & mask;
+					slots[slot] = i;
+				}
+				mSlots.swap(slots);
+			}
+		};
+
+		// the key cell and the aggregated cells of consecutive rows, each cell followed by a zero
+		class AggregateBatch
+		{
+		public:
+			void clear() noexcept
+			{
+				mBytes.clear();
+				mCellEnds.clear();
+			}
+			void push(Deserializer const& row, std::size_t keyColumn, AggregatePlan const& plan)
+			{
+				if(keyColumn >= row.total())
+					throw std::out_of_range("uCSV::aggregate: the key column doesn't exist");
+				append(row.cell(keyColumn));
+				for(const std::size_t column : plan.columns)
+					append(column < row.total() ? row.cell(column) : string_view_t());
+			}
+			[[nodiscard]] std::size_t cells() const noexcept
+			{
+				return mCellEnds.size();
+			}
+			// passes the key and the other cells of every row to table
+			void apply(AggregateTable& table, std::size_t columns, std::vector<string_view_t>& cells) const
+			{
+				cells.clear();
+				std::size_t last = 0;
+				for(const std::size_t end : mCellEnds)
+				{
+					cells.emplace_back(mBytes.data() + last, end - last);
+					last = end + 1;
+				}
+				for(std::size_t i = 0; i < cells.size(); i += columns + 1)
+					table.add(cells[i], cells.data() + i + 1);
+			}
+
+		private:
+			string_t mBytes;
+			std::vector<std::size_t> mCellEnds;
+
+			void append(string_view_t cell)
+			{
+				mBytes.append(cell.data(), cell.size());
+				mCellEnds.push_back(mBytes.size());
+				mBytes.push_back('\0');
+			}
+		};
+	}
+
+	// computes aggregates of columns grouped by the cells of keyColumn while reading, without storing rows. memory grows
+	// with the number of groups only. with more than one thread, the calling thread copies the referenced cells of
+	// batches of rows, which are converted and aggregated by the other threads into partial aggregates that are merged at
+	// the end. bad rows are reported through the error handler of the reader and skipped; cells which don't hold a number
+	// are skipped and counted. a row without the key column throws
+	template<typename ReaderT>
+	AggregateResult aggregate(ReaderT& reader, std::size_t keyColumn, Aggregates const& aggregates, AggregateOptions options = {})
+	{
+		if(options.threads == 0)
+			options.threads = Detail::defaultThreads();
+		if(options.batchRows == 0)
+			options.batchRows = 1;
+		const Detail::AggregatePlan plan(aggregates);
+		const std::size_t columns = plan.columns.size();
+		AggregateResult result;
+
+		if(options.threads == 1)
+		{
+			Detail::AggregateTable table(plan);
+			std::vector<string_view_t> cells(columns);
+			while(!reader.done())
+			{
+				std::optional<Deserializer> row = reader.fetch();
+				if(!row)
+					continue;
+				if(keyColumn >= row->total())
+					throw std::out_of_range("uCSV::aggregate: the key column doesn't exist");
+				for(std::size_t i = 0; i < columns; ++i)
+					cells[i] = plan.columns[i] < row->total() ? row->cell(plan.columns[i]) : string_view_t();
+				table.add(row->cell(keyColumn), cells.data());
+			}
+			table.results(aggregates, result);
+			return result;
+		}
+
+		std::mutex mutex;
+		std::condition_variable work; // signals workers that batches are available
+		std::condition_variable space; // signals the calling thread that batches can be reused
+		std::deque<Detail::AggregateBatch> queue;
+		std::vector<Detail::AggregateBatch> spare(2 * options.threads);
+		bool finished = false;
+		std::exception_ptr error;
+		std::vector<Detail::AggregateTable> tables(options.threads, Detail::AggregateTable(plan));
+		std::vector<std::thread> workers;
+		workers.reserve(options.threads);
+		for(std::size_t i = 0; i < options.threads; ++i)
+		{
+			workers.emplace_back([&, &table = tables[i]]
+			{
+				std::vector<string_view_t> cells;
+				for(;;)
+				{
+					Detail::AggregateBatch batch;
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						work.wait(lock, [&]{ return finished || !queue.empty(); });
+						if(queue.empty())
+							return;
+						batch = std::move(queue.front());
+						queue.pop_front();
+					}
+					try
+					{
+						batch.apply(table, columns, cells);
+					}
+					catch(...)
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						if(!error)
+							error = std::current_exception();
+					}
+					batch.clear();
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						spare.push_back(std::move(batch));
+					}
+					space.notify_one();
+				}
+			});
+		}
+		const auto stop = [&]
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				finished = true;
+			}
+			work.notify_all();
+			for(std::thread& worker : workers)
+				worker.join();
+		};
+
+		try
+		{
+			Detail::AggregateBatch batch;
+			std::size_t rows = 0;
+			const auto emit = [&]
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				queue.push_back(std::move(batch));
+				space.wait(lock, [&]{ return !spare.empty(); });
+				batch = std::move(spare.back());
+				spare.pop_back();
+				lock.unlock();
+				work.notify_one();
+				rows = 0;
+			};
+			while(!reader.done())
+			{
+				std::optional<Deserializer> row = reader.fetch();
+				if(!row)
+					continue;
+				batch.push(*row, keyColumn, plan);
+				if(++rows == options.batchRows)
+					emit();
+			}
+			if(batch.cells() > 0)
+				emit();
+		}
+		catch(...)
+		{
+			stop();
+			throw;
+		}
+		stop();
+		if(error)
+			std::rethrow_exception(error);
+
+		for(std::size_t i = 1; i < tables.size(); ++i)
+			tables[0].merge(tables[i]);
+		tables[0].results(aggregates, result);
+		return result;
+	}
+}
+
+#endif // !UCSV_AGGREGATE_HPP_INCLUDED
@@ -0,0 +1,329 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_ARROW_HPP_INCLUDED
+#define UCSV_ARROW_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <cstdint>
+#include <memory>
+
+// the structures of the Arrow C data interface, verbatim from the specification. they may already have been declared by
+// Arrow itself or by another producer, which the include guard accounts for
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C"
+{
+	struct ArrowSchema
+	{
+		// Array type description
+		const char* format;
+		const char* name;
+		const char* metadata;
+		int64_t flags;
+		int64_t n_children;
+		struct ArrowSchema** children;
+		struct ArrowSchema* dictionary;
+
+		// Release callback
+		void (*release)(struct ArrowSchema*);
+		// Opaque producer-specific data
+		void* private_data;
+	};
+
+	struct ArrowArray
+	{
+		// Array data description
+		int64_t length;
+		int64_t null_count;
+		int64_t offset;
+		int64_t n_buffers;
+		int64_t n_children;
+		const void** buffers;
+		struct ArrowArray** children;
+		struct ArrowArray* dictionary;
+
+		// Release callback
+		void (*release)(struct ArrowArray*);
+		// Opaque producer-specific data
+		void* private_data;
+	};
+}
+
+#endif // ARROW_C_DATA_INTERFACE
+
+// batches of rows are exported as Arrow struct arrays with one child per column: int64 ("l"), float64 ("g") and large
+// UTF-8 strings ("U", 64 bit offsets, so that a batch can't overflow them). the buffers are filled while parsing and are
+// handed over as they are; the consumer frees them by calling release
+namespace uCSV
+{
+	struct ArrowColumn
+	{
+		std::size_t index; // index of the column in the CSV file
+		ColumnType type;
+		string_t name = {}; // taken from the header of the reader if empty
+		bool nullable = true; // empty cells and cells which can't be converted become nulls
+	};
+	using ArrowColumns = std::vector<ArrowColumn>;
+
+	namespace Detail
+	{
+		struct ArrowColumnData
+		{
+			std::vector<std::uint8_t> validity;
+			std::vector<std::int64_t> int64s; // values, or the offsets of strings
+			std::vector<double> float64s;
+			string_t bytes;
+			void const* buffers[3] = {};
+		};
+		struct ArrowBatchData
+		{
+			std::vector<ArrowArray> children;
+			std::vector<ArrowArray*> pointers;
+			void const* buffers[1] = {};
+		};
+		struct ArrowSchemaData
+		{
+			std::vector<ArrowSchema> children;
+			std::vector<ArrowSchema*> pointers;
+		};
+
+		[[nodiscard]] constexpr char const* arrowFormat(ColumnType type) noexcept
+		{
+			switch(type)
+			{
+			case ColumnType::int64:
+				return "l";
+			case ColumnType::float64:
+				return "g";
+			case ColumnType::string:
+				return "U";
+			}
+			return "n";
+		}
+
+		// every column owns its buffers, since the consumer may move it out of the batch and release it separately
+		inline void releaseArrowColumn(ArrowArray* array) noexcept
+		{
+			delete static_cast<ArrowColumnData*>(array->private_data);
+			array->release = nullptr;
+		}
+		inline void releaseArrowBatch(ArrowArray* array) noexcept
+		{
+			for(std::int64_t i = 0; i < array->n_children; ++i)
+				if(array->children[i]->release)
+					array->children[i]->release(array->children[i]);
+			delete static_cast<ArrowBatchData*>(array->private_data);
+			array->release = nullptr;
+		}
+		// like the columns, every child schema owns its name
+		inline void releaseArrowChild(ArrowSchema* schema) noexcept
+		{
+			delete static_cast<string_t*>(schema->private_data);
+			schema->release = nullptr;
+		}
+		inline void releaseArrowSchema(ArrowSchema* schema) noexcept
+		{
+			for(std::int64_t i = 0; i < schema->n_children; ++i)
+				if(schema->children[i]->release)
+					schema->children[i]->release(schema->children[i]);
+			delete static_cast<ArrowSchemaData*>(schema->private_data);
+			schema->release = nullptr;
+		}
+
+		// the rows a batch reserves at most up front, so that maxRows may be effectively unlimited; larger batches grow
+		constexpr std::size_t arrowReserveRows = std::size_t(1) << 16;
+
+		class ArrowColumnBuilder
+		{
+		public:
+			ArrowColumnBuilder(ColumnType type, bool nullable)
+				: mType(type), mNullable(nullable), mData(std::make_unique<ArrowColumnData>())
+			{
+				if(mType == ColumnType::string)
+					mData->int64s.push_back(0);
+			}
+
+			void reserve(std::size_t rows)
+			{
+				mData->validity.reserve((rows + 7) / 8);
+				if(mType == ColumnType::float64)
+					mData->float64s.reserve(rows);
+				else
+					mData->int64s.reserve(rows + 1);
+			}
+
+			// returns false if the cell couldn't be converted; it becomes a null or a zero in that case
+			bool push(string_view_t cell)
+			{
+				bool valid = !mNullable || !cell.empty();
+				bool good = true;
+				switch(mType)
+				{
+				case ColumnType::int64:
+				{
+					std::int64_t value = 0;
+					if(valid && !convertCell(cell, value))
+					{
+						good = false;
+						value = 0;
+						valid = !mNullable;
+					}
+					mData->int64s.push_back(value);
+					break;
+				}
+				case ColumnType::float64:
+				{
+					double value = 0;
+					if(valid && !convertCell(cell, value))
+					{
+						good = false;
+						value = 0;
+						valid = !mNullable;
+					}
+					mData->float64s.push_back(value);
+					break;
+				}
+				case ColumnType::string:
+					if(valid)
+						mData->bytes.append(cell.data(), cell.size());
+					mData->int64s.push_back(static_cast<std::int64_t>(mData->bytes.size()));
+					break;
+				}
+
+				if(mRows % 8 == 0)
+					mData->validity.push_back(0);
+				if(valid)
+					mData->validity.back() |= static_cast<std::uint8_t>(1u << (mRows % 8));
+				else
+					++mNulls;
+				++mRows;
+				return good;
+			}
+
+			// hands the buffers over to array and starts over
+			void finish(ArrowArray& array)
+			{
+				ArrowColumnData& data = *mData;
+				data.buffers[0] = mNulls > 0 ? data.validity.data() : nullptr;
+				switch(mType)
+				{
+				case ColumnType::int64:
+					data.buffers[1] = data.int64s.data();
+					break;
+				case ColumnType::float64:
+					data.buffers[1] = data.float64s.data();
+					break;
+				case ColumnType::string:
+					data.buffers[1] = data.int64s.data();
+					data.buffers[2] = data.bytes.data();
+					break;
+				}
+				array = {};
+				array.length = static_cast<std::int64_t>(mRows);
+				array.null_count = static_cast<std::int64_t>(mNulls);
+				array.n_buffers = mType == ColumnType::string ? 3 : 2;
+				array.buffers = data.buffers;
+				array.release = &releaseArrowColumn;
+				array.private_data = std::exchange(mData, std::make_unique<ArrowColumnData>()).release();
+				if(mType == ColumnType::string)
+					mData->int64s.push_back(0);
+				mRows = 0;
+				mNulls = 0;
+			}
+
+		private:
+			ColumnType mType;
+			bool mNullable;
+			std::unique_ptr<ArrowColumnData> mData;
+			std::size_t mRows = 0;
+			std::size_t mNulls = 0;
+		};
+	}
+
+	// describes the batches fetchArrow produces. the consumer releases schema
+	template<typename ReaderT>
+	void exportArrowSchema(ReaderT const& reader, ArrowColumns const& columns, ArrowSchema& schema)
+	{
+		auto data = std::make_unique<Detail::ArrowSchemaData>();
+		data->children.resize(columns.size());
+		for(std::size_t i = 0; i < columns.size(); ++i)
+		{
+			ArrowColumn const& column = columns[i];
+			ArrowSchema& child = data->children[i];
+			child = {};
+			child.format = Detail::arrowFormat(column.type);
+			auto name = std::make_unique<string_t>(!column.name.empty() || !reader.hasHeader() ? column.name : string_t(reader.header(column.index)));
+			child.name = name->c_str();
+			child.flags = column.nullable ? ARROW_FLAG_NULLABLE : 0;
+			child.release = &Detail::releaseArrowChild;
+			child.private_data = name.release();
+			data->pointers.push_back(&child);
+		}
+
+		schema = {};
+		schema.format = "+s";
+		schema.name = "";
+		schema.n_children = static_cast<std::int64_t>(columns.size());
+		schema.children = data->pointers.data();
+		schema.release = &Detail::releaseArrowSchema;
+		schema.private_data = data.release();
+	}
+
+	// parses up to maxRows rows into a struct array, e.g. all of them with SIZE_MAX. returns the number of rows, which is 0
+	// once the reader is done. array is filled in any case and has to be released by the consumer. cells which can't be
+	// converted are reported through the error handler of the reader
+	template<typename ReaderT>
+	std::size_t fetchArrow(ReaderT& reader, ArrowColumns const& columns, std::size_t maxRows, ArrowArray& array)
+	{
+		std::vector<Detail::ArrowColumnBuilder> builders;
+		builders.reserve(columns.size());
+		for(ArrowColumn const& column : columns)
+		{
+			builders.emplace_back(column.type, column.nullable);
+			builders.back().reserve(std::min(maxRows, Detail::arrowReserveRows));
+		}
+
+		std::size_t rows = 0;
+		while(rows < maxRows && !reader.done())
+		{
+			std::optional<Deserializer> row = reader.fetch();
+			if(!row)
+				continue;
+			for(std::size_t i = 0; i < columns.size(); ++i)
+				if(!builders[i].push(row->cell(columns[i].index)))
+					reader.errorHandler().raiseBadCell(static_cast<unsigned int>(columns[i].index), static_cast<unsigned int>(reader.rows() - 1));
+			++rows;
+		}
+
+		auto data = std::make_unique<Detail::ArrowBatchData>();
+		data->children.resize(columns.size());
+		for(std::size_t i = 0; i < columns.size(); ++i)
+		{
+			builders[i].finish(data->children[i]);
+			data->pointers.push_back(&data->children[i]);
+		}
+
+		array = {};
+		array.length = static_cast<std::int64_t>(rows);
+		array.n_buffers = 1; // the validity bitmap, which is absent
+		array.n_children = static_cast<std::int64_t>(columns.size());
+		array.buffers = data->buffers;
+		array.children = data->pointers.data();
+		array.release = &Detail::releaseArrowBatch;
+		array.private_data = data.release();
+		return rows;
+	}
+}
+
+#endif // !UCSV_ARROW_HPP_INCLUDED
@@ -0,0 +1,288 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_DICTIONARY_HPP_INCLUDED
+#define UCSV_DICTIONARY_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+
+namespace uCSV
+{
+	// thread-safe string pool mapping every distinct string to a dense integer code. the empty string always has the code
+	// 0. pooled strings never move, hence views into the pool stay valid for the lifetime of the dictionary
+	template<typename CodeT = std::uint32_t>
+	class Dictionary
+	{
+	public:
+		static_assert(std::is_unsigned_v<CodeT>, "codes have to be unsigned");
+		using CodeType = CodeT;
+
+		Dictionary()
+			: mSlots(initialSlots)
+		{
+			intern(string_view_t());
+		}
+		Dictionary(Dictionary const&) = delete;
+		Dictionary& operator=(Dictionary const&) = delete;
+
+		// the pooled copy of str and its code; the string is hashed only once
+		std::pair<CodeType, string_view_t> insert(string_view_t str)
+		{
+			const std::uint64_t hashed = uCSV::hash(str);
+			{
+				std::shared_lock<std::shared_mutex> lock(mMutex);
+				if(const std::size_t slot = probe(str, hashed); mSlots[slot].code != 0)
+					return entry(mSlots[slot].code - 1);
+			}
+			std::unique_lock<std::shared_mutex> lock(mMutex);
+			std::size_t slot = probe(str, hashed);
+			if(mSlots[slot].code != 0)
+				return entry(mSlots[slot].code - 1);
+
+			if(mValues.size() >= static_cast<std::size_t>(std::numeric_limits<CodeType>::max()))
+				throw std::length_error("uCSV::Dictionary: too many distinct values for the code type");
+			if((mValues.size() + 1) * 2 > mSlots.size())
+			{
+				grow();
+				slot = probe(str, hashed);
+			}
+			const auto code = static_cast<CodeType>(mValues.size());
+			mValues.emplace_back(str);
+			mSlots[slot] = { hashed, static_cast<CodeType>(code + 1) };
+			return entry(code);
+		}
+		CodeType intern(string_view_t str)
+		{
+			return insert(str).first;
+		}
+		[[nodiscard]] std::optional<CodeType> find(string_view_t str) const
+		{
+			std::shared_lock<std::shared_mutex> lock(mMutex);
+			const std::size_t slot = probe(str, uCSV::hash(str));
+			if(mSlots[slot].code == 0)
+				return std::nullopt;
+			return static_cast<CodeType>(mSlots[slot].code - 1);
+		}
+
+		[[nodiscard]] string_view_t operator[](CodeType code) const
+		{
+			std::shared_lock<std::shared_mutex> lock(mMutex);
+			assert(code < mValues.size());
+			return mValues[code];
+		}
+		// number of distinct strings, including the empty string
+		[[nodiscard]] std::size_t size() const
+		{
+			std::shared_lock<std::shared_mutex> lock(mMutex);
+			return mValues.size();
+		}
+
+	private:
+		static constexpr std::size_t initialSlots = 64;
+
+		struct Slot
+		{
+			std::uint64_t hash;
+			CodeType code; // code + 1, 0 marks an empty slot
+		};
+
+		mutable std::shared_mutex mMutex;
+		std::deque<string_t> mValues; // a deque never relocates its elements
+		std::vector<Slot> mSlots; // open addressing with linear probing, the size is a power of two
+
+		[[nodiscard]] std::pair<CodeType, string_view_t> entry(CodeType code) const
+		{
+			return { code, mValues[code] };
+		}
+		// either the slot containing str or the empty slot where it would have to be inserted
+		[[nodiscard]] std::size_t probe(string_view_t str, std::uint64_t hashed) const noexcept
+		{
+			const std::size_t mask = mSlots.size() - 1;
+			for(std::size_t slot = static_cast<std::size_t>(hashed) & mask;; slot = (slot + 1) & mask)
+			{
+				Slot const& candidate = mSlots[slot];
+				if(candidate.code == 0 || (candidate.hash == hashed && mValues[candidate.code - 1] == str))
+					return slot;
+			}
+		}
+		void grow()
+		{
+			std::vector<Slot> slots(mSlots.size() * 2);
+			const std::size_t mask = slots.size() - 1;
+			for(Slot const& old : mSlots)
+			{
+				if(old.code == 0)
+					continue;
+				std::size_t slot = static_cast<std::size_t>(old.hash) & mask;
+				while(slots[slot].code != 0)
+					slot = (slot + 1) & mask;
+				slots[slot] = old;
+			}
+			mSlots = std::move(slots);
+		}
+	};
+
+	// deserialization target storing a string in a process-wide dictionary shared by all interned strings with the same
+	// Tag, which lives until the process exits. copying is trivial and comparisons for equality only compare the codes.
+	// see Coded for dictionaries owned by the caller
+	template<typename Tag = void, typename CodeT = std::uint32_t>
+	class InternedString
+	{
+	public:
+		using DictionaryType = Dictionary<CodeT>;
+		using CodeType = CodeT;
+
+		[[nodiscard]] static DictionaryType& dictionary()
+		{
+			static DictionaryType instance;
+			return instance;
+		}
+
+		constexpr InternedString() noexcept = default;
+		explicit InternedString(string_view_t str)
+		{
+			std::tie(mCode, mView) = dictionary().insert(str);
+		}
+
+		[[nodiscard]] constexpr CodeType code() const noexcept
+		{
+			return mCode;
+		}
+		[[nodiscard]] constexpr string_view_t view() const noexcept
+		{
+			return mView;
+		}
+		[[nodiscard]] constexpr operator string_view_t() const noexcept
+		{
+			return mView;
+		}
+
+		[[nodiscard]] friend constexpr bool operator==(InternedString const& lhs, InternedString const& rhs) noexcept
+		{
+			return lhs.mCode == rhs.mCode;
+		}
+		[[nodiscard]] friend constexpr bool operator!=(InternedString const& lhs, InternedString const& rhs) noexcept
+		{
+			return lhs.mCode != rhs.mCode;
+		}
+		// lexicographic order; compare code() instead if any consistent order suffices
+		[[nodiscard]] friend constexpr bool operator<(InternedString const& lhs, InternedString const& rhs) noexcept
+		{
+			return lhs.mView < rhs.mView;
+		}
+
+		friend void deserialize(Deserializer& data, InternedString& target)
+		{
+			target = InternedString(data.next());
+		}
+
+	private:
+		CodeType mCode = 0;
+		string_view_t mView;
+	};
+
+	// deserialization target storing a string in a dictionary owned by the caller, e.g. one per column or per load, which
+	// is freed along with it. a Coded is bound to its dictionary on construction and deserializing into it keeps the
+	// binding, hence a row is built once with bound cells and fetched into repeatedly, e.g. a
+	// std::tuple<int, Coded<>> row(0, Coded<>(countries)). deserializing into an unbound Coded throws. comparisons for
+	// equality compare the dictionaries and the codes
+	template<typename CodeT = std::uint32_t>
+	class Coded
+	{
+	public:
+		using DictionaryType = Dictionary<CodeT>;
+		using CodeType = CodeT;
+
+		constexpr Coded() noexcept = default;
+		constexpr explicit Coded(DictionaryType& dictionary) noexcept
+			: mDictionary(&dictionary)
+		{
+		}
+		Coded(DictionaryType& dictionary, string_view_t str)
+			: mDictionary(&dictionary)
+		{
+			assign(str);
+		}
+
+		void assign(string_view_t str)
+		{
+			if(!mDictionary)
+				throw std::logic_error("uCSV::Coded: not bound to a dictionary");
+			std::tie(mCode, mView) = mDictionary->insert(str);
+		}
+
+		// nullptr if unbound
+		[[nodiscard]] constexpr DictionaryType* dictionary() const noexcept
+		{
+			return mDictionary;
+		}
+		[[nodiscard]] constexpr CodeType code() const noexcept
+		{
+			return mCode;
+		}
+		[[nodiscard]] constexpr string_view_t view() const noexcept
+		{
+			return mView;
+		}
+		[[nodiscard]] constexpr operator string_view_t() const noexcept
+		{
+			return mView;
+		}
+
+		[[nodiscard]] friend constexpr bool operator==(Coded const& lhs, Coded const& rhs) noexcept
+		{
+			return lhs.mCode == rhs.mCode && lhs.mDictionary == rhs.mDictionary;
+		}
+		[[nodiscard]] friend constexpr bool operator!=(Coded const& lhs, Coded const& rhs) noexcept
+		{
+			return !(lhs == rhs);
+		}
+		// lexicographic order; compare code() instead if any consistent order within one dictionary suffices
+		[[nodiscard]] friend constexpr bool operator<(Coded const& lhs, Coded const& rhs) noexcept
+		{
+			return lhs.mView < rhs.mView;
+		}
+
+		friend void deserialize(Deserializer& data, Coded& target)
+		{
+			target.assign(data.next());
+		}
+
+	private:
+		DictionaryType* mDictionary = nullptr;
+		CodeType mCode = 0;
+		string_view_t mView;
+	};
+}
+
+namespace std
+{
+	template<typename Tag, typename CodeT>
+	struct hash<uCSV::InternedString<Tag, CodeT>>
+	{
+		[[nodiscard]] std::size_t operator()(uCSV::InternedString<Tag, CodeT> const& str) const noexcept
+		{
+			return std::hash<CodeT>()(str.code());
+		}
+	};
+	template<typename CodeT>
+	struct hash<uCSV::Coded<CodeT>>
+	{
+		[[nodiscard]] std::size_t operator()(uCSV::Coded<CodeT> const& str) const noexcept
+		{
+			return std::hash<CodeT>()(str.code());
+		}
+	};
+}
+
+#endif // !UCSV_DICTIONARY_HPP_INCLUDED
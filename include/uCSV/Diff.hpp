@@ -0,0 +1,461 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_DIFF_HPP_INCLUDED
+#define UCSV_DIFF_HPP_INCLUDED
+
+#include <uCSV.hpp>
+#include <uCSV/Spill.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace uCSV
+{
+	enum class Change
+	{
+		inserted,
+		deleted,
+		changed,
+	};
+
+	struct DiffOptions
+	{
+		std::size_t memory = std::size_t(256) << 20; // bytes of the table of the old version held in memory at once
+		std::size_t partitions = 64; // files each version is split into once the table exceeds memory
+		std::filesystem::path temporaryDirectory = {}; // empty picks the one of the system
+	};
+
+	struct DiffStatistics
+	{
+		std::size_t inserted = 0;
+		std::size_t deleted = 0;
+		std::size_t changed = 0;
+		std::size_t unchanged = 0;
+		std::size_t partitions = 0; // partitions compared one by one; 0 if the table of the old version fit into memory
+	};
+
+	namespace Detail
+	{
+		// the rows of the old version, identified by the hashes of their keys. only hashes and the positions of the records
+		// are stored, hence the table takes memory proportional to the number of rows of the old version, but not to their
+		// size. keys whose hashes collide are told apart by the callers, which re-read the records
+		template<typename PositionT>
+		class DiffTable
+		{
+		public:
+			static constexpr std::size_t none = ~std::size_t(0);
+
+			struct Entry
+			{
+				std::uint64_t key = 0;
+				std::uint64_t row = 0;
+				PositionT position{};
+				std::size_t ordinal = none; // the index of the row in the old version; none marks an empty slot
+				bool seen = false;
+			};
+
+			DiffTable()
+				: mEntries(64)
+			{
+			}
+
+			// same(entry) decides whether an entry with an equal hash has an equal key. returns false if it has
+			template<typename SameT>
+			bool insert(std::uint64_t key, std::uint64_t row, PositionT position, std::size_t ordinal, SameT&& same)
+			{
+				if((mSize + 1) * 2 > mEntries.size())
+					grow();
+				const std::size_t mask = mEntries.size() - 1;
+				for(std::size_t slot = static_cast<std::size_t>(key) & mask;; slot = (slot + 1) & mask)
+				{
+					Entry& entry = mEntries[slot];
+					if(entry.ordinal == none)
+					{
+						entry = { key, row, std::move(position), ordinal, false };
+						++mSize;
+						return true;
+					}
+					if(entry.key == key && same(entry))
+						return false;
+				}
+			}
+			template<typename SameT>
+			[[nodiscard]] Entry* find(std::uint64_t key, SameT&& same)
+			{
+				const std::size_t mask = mEntries.size() - 1;
+				for(std::size_t slot = static_cast<std::size_t>(key) & mask;; slot = (slot + 1) & mask)
+				{
+					Entry& entry = mEntries[slot];
+					if(entry.ordinal == none)
+						return nullptr;
+					if(entry.key == key && same(entry))
+						return &entry;
+				}
+			}
+			[[nodiscard]] std::vector<Entry> const& entries() const noexcept
+			{
+				return mEntries;
+			}
+			[[nodiscard]] std::size_t bytes() const noexcept
+			{
+				return mEntries.size() * sizeof(Entry);
+			}
+
+		private:
+			std::vector<Entry> mEntries; // open addressing with linear probing, the size is a power of two
+			std::size_t mSize = 0;
+
+			void grow()
+			{
+				std::vector<Entry> old(mEntries.size() * 2);
+				old.swap(mEntries);
+				const std::size_t mask = mEntries.size() - 1;
+				for(Entry& entry : old)
+				{
+					if(entry.ordinal == none)
+						continue;
+					std::size_t slot = static_cast<std::size_t>(entry.key) & mask;
+					while(mEntries[slot].ordinal != none)
+						slot = (slot + 1) & mask;
+					mEntries[slot] = std::move(entry);
+				}
+			}
+		};
+
+		// the partitioned diff: both versions are split into files by the hashes of their keys, and the partitions are
+		// compared one by one with the whole rows of the old version in memory. partitions which still don't fit are split
+		// again with another hash, up to maxLevels times
+		template<typename CallbackT>
+		class PartitionedDiff
+		{
+		public:
+			static constexpr std::size_t maxLevels = 3;
+
+			PartitionedDiff(std::size_t keyColumn, CallbackT& callback, DiffOptions const& options, DiffStatistics& result, std::vector<string_t> beforeHeader, std::vector<string_t> afterHeader)
+				: mKeyColumn(keyColumn), mCallback(callback), mOptions(options), mResult(result), mFiles(options.temporaryDirectory),
+				mBeforeHeader(std::move(beforeHeader)), mAfterHeader(std::move(afterHeader))
+			{
+				mOptions.partitions = std::max<std::size_t>(mOptions.partitions, 2);
+			}
+
+			template<typename ReaderT>
+			void run(ReaderT& before, ReaderT& after)
+			{
+				const std::vector<std::filesystem::path> beforePaths = split(before);
+				const std::vector<std::filesystem::path> afterPaths = split(after);
+				comparePartitions(beforePaths, afterPaths, 1);
+			}
+
+		private:
+			// the ordinal of a row within its version and the hash of the row, which precede it in the partition files
+			struct Record
+			{
+				std::uint64_t ordinal = 0;
+				std::uint64_t row = 0;
+			};
+
+			std::size_t mKeyColumn;
+			CallbackT& mCallback;
+			DiffOptions mOptions;
+			DiffStatistics& mResult;
+			TemporaryFiles mFiles;
+			std::vector<string_t> mBeforeHeader;
+			std::vector<string_t> mAfterHeader;
+
+			[[nodiscard]] std::size_t partition(string_view_t key, std::size_t level) const noexcept
+			{
+				return static_cast<std::size_t>(uCSV::hash(key, level + 1) % mOptions.partitions);
+			}
+			[[nodiscard]] std::vector<std::filesystem::path> createPartitions()
+			{
+				std::vector<std::filesystem::path> paths;
+				for(std::size_t i = 0; i < mOptions.partitions; ++i)
+					paths.push_back(mFiles.create());
+				return paths;
+			}
+			static void write(std::ofstream& file, Record const& record)
+			{
+				file.write(reinterpret_cast<char const*>(&record), sizeof(record));
+			}
+			// appends the row to rows; false at the end of the file
+			static bool read(std::ifstream& file, Record& record, SpillRows& rows)
+			{
+				if(!file.read(reinterpret_cast<char*>(&record), sizeof(record)))
+					return false;
+				if(!rows.read(file))
+					throw std::runtime_error("uCSV: a temporary file is truncated");
+				return true;
+			}
+
+			template<typename ReaderT>
+			[[nodiscard]] std::vector<std::filesystem::path> split(ReaderT& reader)
+			{
+				const std::vector<std::filesystem::path> paths = createPartitions();
+				SpillPartitions files(paths);
+				for(std::uint64_t ordinal = 0; !reader.done();)
+				{
+					std::optional<Deserializer> row = reader.fetch();
+					if(!row)
+						continue;
+					if(mKeyColumn >= row->total())
+						throw std::out_of_range("uCSV::diff: the key column doesn't exist");
+					std::ofstream& file = files[partition(row->cell(mKeyColumn), 0)];
+					write(file, { ordinal++, reader.rowHash() });
+					writeSpillRow(file, *row);
+				}
+				files.flush();
+				return paths;
+			}
+
+			void comparePartitions(std::vector<std::filesystem::path> const& beforePaths, std::vector<std::filesystem::path> const& afterPaths, std::size_t level)
+			{
+				for(std::size_t i = 0; i < beforePaths.size(); ++i)
+				{
+					comparePartition(beforePaths[i], afterPaths[i], level);
+					mFiles.remove(beforePaths[i]);
+					mFiles.remove(afterPaths[i]);
+				}
+			}
+			void comparePartition(std::filesystem::path const& beforePath, std::filesystem::path const& afterPath, std::size_t level)
+			{
+				++mResult.partitions;
+				std::ifstream beforeFile(beforePath, std::ifstream::binary);
+				std::ifstream afterFile(afterPath, std::ifstream::binary);
+				if(!beforeFile || !afterFile)
+					throw std::runtime_error("uCSV: failed to open a temporary file");
+				SpillRows old;
+				std::vector<Record> records;
+				DiffTable<std::size_t> table;
+				bool fits = true;
+				for(Record record; fits && read(beforeFile, record, old);)
+				{
+					records.push_back(record);
+					fits = level >= maxLevels || old.bytes() + records.size() * (sizeof(Record) + 2 * sizeof(typename DiffTable<std::size_t>::Entry)) <= mOptions.memory;
+				}
+
+				if(!fits)
+				{
+					// the partition itself is replaced by its parts
+					--mResult.partitions;
+					const std::vector<std::filesystem::path> beforePaths = createPartitions();
+					{
+						SpillPartitions files(beforePaths);
+						for(std::size_t i = 0; i < old.size(); ++i)
+						{
+							std::ofstream& file = files[partition(old.cell(i, mKeyColumn), level)];
+							write(file, records[i]);
+							old.write(file, i);
+						}
+						old.clear();
+						SpillRows row;
+						for(Record record; row.clear(), read(beforeFile, record, row);)
+						{
+							std::ofstream& file = files[partition(row.cell(0, mKeyColumn), level)];
+							write(file, record);
+							row.write(file, 0);
+						}
+						files.flush();
+					}
+					const std::vector<std::filesystem::path> afterPaths = createPartitions();
+					{
+						SpillPartitions files(afterPaths);
+						SpillRows row;
+						for(Record record; row.clear(), read(afterFile, record, row);)
+						{
+							std::ofstream& file = files[partition(row.cell(0, mKeyColumn), level)];
+							write(file, record);
+							row.write(file, 0);
+						}
+						files.flush();
+					}
+					comparePartitions(beforePaths, afterPaths, level + 1);
+					return;
+				}
+
+				old.finish();
+				const auto sameAs = [&](string_view_t key)
+				{
+					return [this, &old, key](typename DiffTable<std::size_t>::Entry const& entry)
+					{
+						return old.cell(entry.position, mKeyColumn) == key;
+					};
+				};
+				for(std::size_t i = 0; i < records.size(); ++i)
+				{
+					const string_view_t key = old.cell(i, mKeyColumn);
+					if(!table.insert(uCSV::hash(key), records[i].row, i, static_cast<std::size_t>(records[i].ordinal), sameAs(key)))
+						throw std::runtime_error("uCSV::diff: duplicate key " + string_t(key));
+				}
+
+				// the rows of the new version keep their order within the partition
+				SpillRows row;
+				for(Record record; row.clear(), read(afterFile, record, row);)
+				{
+					row.finish();
+					const string_view_t key = row.cell(0, mKeyColumn);
+					Deserializer current = row.row(0, mAfterHeader);
+					typename DiffTable<std::size_t>::Entry* const entry = table.find(uCSV::hash(key), sameAs(key));
+					if(!entry)
+					{
+						++mResult.inserted;
+						mCallback(Change::inserted, static_cast<Deserializer*>(nullptr), &current);
+						continue;
+					}
+					entry->seen = true;
+					if(entry->row == record.row)
+					{
+						++mResult.unchanged;
+						continue;
+					}
+					++mResult.changed;
+					Deserializer previous = old.row(entry->position, mBeforeHeader);
+					mCallback(Change::changed, &previous, &current);
+				}
+
+				std::vector<typename DiffTable<std::size_t>::Entry const*> deleted;
+				for(auto const& entry : table.entries())
+					if(entry.ordinal != DiffTable<std::size_t>::none && !entry.seen)
+						deleted.push_back(&entry);
+				std::sort(deleted.begin(), deleted.end(), [](auto const* a, auto const* b)
+				{
+					return a->ordinal < b->ordinal;
+				});
+				for(auto const* const entry : deleted)
+				{
+					Deserializer previous = old.row(entry->position, mBeforeHeader);
+					++mResult.deleted;
+					mCallback(Change::deleted, &previous, static_cast<Deserializer*>(nullptr));
+				}
+			}
+		};
+	}
+
+	// compares two versions of a table whose rows are identified by the cell in keyColumn. callback is invoked as
+	// callback(Change, Deserializer* before, Deserializer* after) for every inserted, deleted and changed row, where the
+	// absent side is nullptr. the new version is read once, sequentially; the old one is read once and afterwards only the
+	// records which have been deleted or changed, or whose key hashes collide, are read again. rows are compared by their
+	// 64 bit hashes, keys by their bytes, except that a row whose key and row hash both equal those of an old row is taken
+	// to be that row unchanged without reading it again. like the comparison of rows, that assumes that distinct rows
+	// don't collide in 64 bits, which happens with a chance of about n^2 / 2^65 for n rows. the table of the old version
+	// takes memory proportional to its number of rows; if it exceeds options.memory, the old version is read again and
+	// both are instead partitioned into temporary files by the hashes of their keys and compared partition by partition.
+	// the changes are then grouped by partition. both readers have to be positioned at their first row and need multi-pass
+	// iterators. throws if the old version contains a key twice
+	template<typename ReaderT, typename CallbackT>
+	DiffStatistics diff(ReaderT& before, ReaderT& after, std::size_t keyColumn, CallbackT&& callback, DiffOptions const& options = {})
+	{
+		using IteratorType = typename ReaderT::InputIteratorBeginType;
+		static_assert(
+			std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<IteratorType>::iterator_category>,
+			"the old version is read twice, hence it requires forward iterators"
+		);
+		using TableType = Detail::DiffTable<IteratorType>;
+
+		// the old version is re-read from the recorded positions
+		const auto recall = [&before](IteratorType const& position) -> std::optional<Deserializer>
+		{
+			before.seek(position);
+			std::optional<Deserializer> row = before.fetch();
+			if(!row)
+				throw std::runtime_error("uCSV::diff: the old version changed while being compared");
+			return row;
+		};
+
+		DiffStatistics result;
+		TableType table;
+		const IteratorType start = before.position();
+		for(std::size_t ordinal = 0; !before.done();)
+		{
+			IteratorType position = before.position();
+			std::optional<Deserializer> row = before.fetch();
+			if(!row)
+				continue;
+			if(keyColumn >= row->total())
+				throw std::out_of_range("uCSV::diff: the key column doesn't exist");
+			const string_view_t cell = row->cell(keyColumn);
+			const std::uint64_t key = uCSV::hash(cell);
+			const std::uint64_t rowHash = before.rowHash();
+			// recalling overwrites the row, hence the key is copied first and reading resumes after the row
+			std::optional<string_t> copy;
+			const auto same = [&](typename TableType::Entry const& entry)
+			{
+				if(!copy)
+					copy.emplace(cell);
+				const IteratorType next = before.position();
+				const bool equal = recall(entry.position)->cell(keyColumn) == *copy;
+				before.seek(next);
+				return equal;
+			};
+			if(!table.insert(key, rowHash, std::move(position), ordinal++, same))
+				throw std::runtime_error("uCSV::diff: duplicate key " + *copy);
+			if(table.bytes() > options.memory)
+			{
+				table = TableType();
+				before.seek(start);
+				Detail::PartitionedDiff<std::remove_reference_t<CallbackT>> partitioned(keyColumn, callback, options, result, Detail::headerNames(before), Detail::headerNames(after));
+				partitioned.run(before, after);
+				return result;
+			}
+		}
+
+		while(!after.done())
+		{
+			std::optional<Deserializer> row = after.fetch();
+			if(!row)
+				continue;
+			if(keyColumn >= row->total())
+				throw std::out_of_range("uCSV::diff: the key column doesn't exist");
+			const string_view_t key = row->cell(keyColumn);
+			const std::uint64_t rowHash = after.rowHash();
+			// the key is part of the row, hence equal row hashes are taken to imply equal keys, see above; otherwise the old
+			// row is read anyway
+			std::optional<Deserializer> old;
+			typename TableType::Entry* const entry = table.find(uCSV::hash(key), [&](typename TableType::Entry const& candidate)
+			{
+				if(candidate.row == rowHash)
+					return true;
+				old = recall(candidate.position);
+				return old->cell(keyColumn) == key;
+			});
+			if(!entry)
+			{
+				++result.inserted;
+				callback(Change::inserted, static_cast<Deserializer*>(nullptr), &*row);
+				continue;
+			}
+			entry->seen = true;
+			if(entry->row == rowHash)
+			{
+				++result.unchanged;
+				continue;
+			}
+			++result.changed;
+			callback(Change::changed, &*old, &*row);
+		}
+
+		// deleted rows are reported in the order of the old version
+		std::vector<typename TableType::Entry const*> deleted;
+		for(typename TableType::Entry const& entry : table.entries())
+			if(entry.ordinal != TableType::none && !entry.seen)
+				deleted.push_back(&entry);
+		std::sort(deleted.begin(), deleted.end(), [](auto const* a, auto const* b)
+		{
+			return a->ordinal < b->ordinal;
+		});
+		for(typename TableType::Entry const* const entry : deleted)
+		{
+			std::optional<Deserializer> old = recall(entry->position);
+			++result.deleted;
+			callback(Change::deleted, &*old, static_cast<Deserializer*>(nullptr));
+		}
+		return result;
+	}
+}
+
+#endif // !UCSV_DIFF_HPP_INCLUDED
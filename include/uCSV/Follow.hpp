@@ -0,0 +1,369 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_FOLLOW_HPP_INCLUDED
+#define UCSV_FOLLOW_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#define UCSV_FOLLOW_STAT 1
+#endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define UCSV_FOLLOW_INOTIFY 1
+#endif
+
+namespace uCSV
+{
+	namespace Detail
+	{
+		// the bytes read from the followed file which haven't been consumed by the reader yet
+		struct FollowBuffer
+		{
+			string_t data;
+			std::uint64_t base = 0; // file offset of data[0]
+			std::uint64_t complete = 0; // file offset one past the last complete record
+		};
+
+		// iterates over the complete records in a FollowBuffer. the end iterator moves along as more records are completed,
+		// which lets a single Reader resume where it stopped
+		class FollowIterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = char_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = char_t const*;
+			using reference = char_t const&;
+
+			static constexpr std::uint64_t endPosition = ~std::uint64_t(0);
+
+			FollowIterator() noexcept = default;
+			FollowIterator(FollowBuffer const* buffer, std::uint64_t position) noexcept
+				: mBuffer(buffer), mPosition(position)
+			{
+			}
+
+			[[nodiscard]] reference operator*() const noexcept
+			{
+				assert(mPosition != endPosition && mPosition >= mBuffer->base && mPosition < mBuffer->complete);
+				return mBuffer->data[static_cast<std::size_t>(mPosition - mBuffer->base)];
+			}
+			FollowIterator& operator++() noexcept
+			{
+				++mPosition;
+				return *this;
+			}
+			FollowIterator operator++(int) noexcept
+			{
+				FollowIterator result = *this;
+				++mPosition;
+				return result;
+			}
+
+			[[nodiscard]] friend bool operator==(FollowIterator const& lhs, FollowIterator const& rhs) noexcept
+			{
+				return lhs.resolve() == rhs.resolve();
+			}
+			[[nodiscard]] friend bool operator!=(FollowIterator const& lhs, FollowIterator const& rhs) noexcept
+			{
+				return !(lhs == rhs);
+			}
+
+		private:
+			FollowBuffer const* mBuffer = nullptr;
+			std::uint64_t mPosition = endPosition;
+
+			[[nodiscard]] std::uint64_t resolve() const noexcept
+			{
+				return mPosition == endPosition ? mBuffer->complete : mPosition;
+			}
+		};
+	}
+
+	// follows a file that is being appended to, like tail -F. only complete records are handed to the reader, so the parser
+	// never has to backtrack. truncated files are read again from the start and rotated files (a new file at the same path)
+	// are switched to once the old one has been read completely
+	template<typename ErrorHandlerT = ErrorIgnore, typename DelimiterMatcherT = DefaultDelimiter>
+	class Follower
+	{
+	public:
+		using ErrorHandlerType = ErrorHandlerT;
+		using DelimiterMatcherType = DelimiterMatcherT;
+		using ReaderType = Reader<Detail::FollowIterator, ErrorHandlerType, DelimiterMatcherType>;
+
+		template<bool doReadHeader>
+		Follower(std::filesystem::path path, std::bool_constant<doReadHeader> constant)
+			: Follower(std::move(path), ErrorHandlerType(), DelimiterMatcherType(), constant)
+		{
+		}
+		template<bool doReadHeader>
+		Follower(std::filesystem::path path, ErrorHandlerType errorHandler, std::bool_constant<doReadHeader> constant)
+			: Follower(std::move(path), std::move(errorHandler), DelimiterMatcherType(), constant)
+		{
+		}
+		template<bool doReadHeader>
+		Follower(std::filesystem::path path, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, std::bool_constant<doReadHeader>)
+			: mPath(std::move(path)), mErrorHandler(std::move(errorHandler)), mDelimiterMatcher(std::move(delimiterMatcher)), mReadHeader(doReadHeader),
+			mBuffer(std::make_unique<Detail::FollowBuffer>())
+		{
+			open();
+		}
+		Follower(Follower const&) = delete;
+		Follower& operator=(Follower const&) = delete;
+		~Follower()
+		{
+#ifdef UCSV_FOLLOW_INOTIFY
+			if(mNotify >= 0)
+				::close(mNotify);
+#endif
+		}
+
+		// without inotify support the file is checked at this interval
+		void pollInterval(std::chrono::milliseconds interval) noexcept
+		{
+			mPollInterval = interval;
+		}
+
+		[[nodiscard]] ErrorHandlerType& errorHandler() noexcept
+		{
+			return mReader ? mReader->errorHandler() : mErrorHandler;
+		}
+		[[nodiscard]] ReaderType const* reader() const noexcept
+		{
+			return mReader ? &*mReader : nullptr;
+		}
+		// number of rows delivered thus far, excluding headers
+		[[nodiscard]] std::size_t delivered() const noexcept
+		{
+			return mDelivered;
+		}
+
+		// waits up to timeout for new complete records and passes every one to callback as a Deserializer&. returns as
+		// soon as at least one row has been delivered. returns the number of rows delivered
+		template<typename CallbackT>
+		std::size_t poll(CallbackT&& callback, std::chrono::milliseconds timeout = std::chrono::milliseconds(0))
+		{
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			for(;;)
+			{
+				std::size_t result = 0;
+				if(rotated())
+				{
+					// whatever the old file still contains is final, even an unterminated last record
+					readAvailable(true);
+					result += drain(callback);
+					open();
+				}
+				else if(truncated())
+				{
+					open();
+				}
+				readAvailable(false);
+				result += drain(callback);
+
+				const auto now = std::chrono::steady_clock::now();
+				if(result > 0 || now >= deadline)
+					return result;
+				wait(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now) + std::chrono::milliseconds(1));
+			}
+		}
+
+	private:
+		std::filesystem::path mPath;
+		ErrorHandlerType mErrorHandler; // only valid while there is no reader
+		DelimiterMatcherType mDelimiterMatcher;
+		bool mReadHeader;
+		std::chrono::milliseconds mPollInterval{ 10 };
+
+		std::ifstream mFile;
+		std::uint64_t mReadOffset = 0;
+#ifdef UCSV_FOLLOW_STAT
+		dev_t mDevice = 0;
+		ino_t mInode = 0;
+#endif
+#ifdef UCSV_FOLLOW_INOTIFY
+		int mNotify = -1;
+		int mWatch = -1;
+#endif
+
+		// the reader keeps a pointer to the buffer, hence it mustn't move along with the follower
+		std::unique_ptr<Detail::FollowBuffer> mBuffer;
+		std::uint64_t mScanned = 0; // file offset up to which records have been searched for
+		bool mInQuotes = false;
+		std::optional<ReaderType> mReader;
+		bool mRebind = false; // the reader has to be reset onto the reopened file
+		std::size_t mDelivered = 0;
+
+		void open()
+		{
+			mRebind = mReader.has_value();
+			mBuffer->data.clear();
+			mBuffer->base = 0;
+			mBuffer->complete = 0;
+			mScanned = 0;
+			mInQuotes = false;
+			mReadOffset = 0;
+
+			mFile.close();
+			mFile.clear();
+			mFile.open(mPath, std::ifstream::binary);
+#ifdef UCSV_FOLLOW_STAT
+			struct ::stat info;
+			if(mFile.is_open() && ::stat(mPath.c_str(), &info) == 0)
+			{
+				mDevice = info.st_dev;
+				mInode = info.st_ino;
+			}
+#endif
+#ifdef UCSV_FOLLOW_INOTIFY
+			if(mNotify < 0)
+				mNotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if(mNotify >= 0)
+			{
+				if(mWatch >= 0)
+					::inotify_rm_watch(mNotify, mWatch);
+				mWatch = mFile.is_open() ? ::inotify_add_watch(mNotify, mPath.c_str(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF) : -1;
+			}
+#endif
+		}
+
+		[[nodiscard]] bool rotated() const
+		{
+			if(!mFile.is_open())
+			{
+				std::error_code ec;
+				return std::filesystem::exists(mPath, ec);
+			}
+#ifdef UCSV_FOLLOW_STAT
+			struct ::stat info;
+			if(::stat(mPath.c_str(), &info) != 0)
+				return false; // moved away but not replaced yet; keep reading the old file
+			return info.st_dev != mDevice || info.st_ino != mInode;
+#else
+			return false;
+#endif
+		}
+		[[nodiscard]] bool truncated() const
+		{
+			std::error_code ec;
+			const std::uintmax_t size = std::filesystem::file_size(mPath, ec);
+			return !ec && size < mReadOffset;
+		}
+
+		void readAvailable(bool final)
+		{
+			if(!mFile.is_open())
+				return;
+			Detail::FollowBuffer& buffer = *mBuffer;
+			constexpr std::size_t chunk = 1 << 16;
+			for(;;)
+			{
+				mFile.clear();
+				const std::size_t size = buffer.data.size();
+				buffer.data.resize(size + chunk);
+				mFile.read(buffer.data.data() + size, static_cast<std::streamsize>(chunk));
+				const auto read = static_cast<std::size_t>(mFile.gcount());
+				buffer.data.resize(size + read);
+				mReadOffset += read;
+				if(read < chunk)
+					break;
+			}
+			mFile.clear();
+
+			const std::uint64_t end = buffer.base + buffer.data.size();
+			for(; mScanned < end; ++mScanned)
+			{
+				const char_t c = buffer.data[static_cast<std::size_t>(mScanned - buffer.base)];
+				if(c == '"')
+					mInQuotes = !mInQuotes;
+				else if(!mInQuotes && isNewline(c))
+				{
+					// a trailing \r might be followed by a \n which hasn't been written yet
+					if(c == '\r' && mScanned + 1 == end && !final)
+						break;
+					buffer.complete = mScanned + 1;
+				}
+			}
+			if(final)
+				buffer.complete = end;
+		}
+
+		template<typename CallbackT>
+		std::size_t drain(CallbackT& callback)
+		{
+			Detail::FollowBuffer& buffer = *mBuffer;
+			std::size_t result = 0;
+			if(buffer.complete == buffer.base)
+				return result;
+
+			// the header is read as soon as the reader is created, hence not before there is a complete record
+			const Detail::FollowIterator begin(&buffer, buffer.base);
+			const Detail::FollowIterator end(&buffer, Detail::FollowIterator::endPosition);
+			if(!mReader)
+			{
+				if(mReadHeader)
+					mReader.emplace(begin, end, std::move(mErrorHandler), mDelimiterMatcher, uCSV::readHeader);
+				else
+					mReader.emplace(begin, end, std::move(mErrorHandler), mDelimiterMatcher, uCSV::ignoreHeader);
+			}
+			else if(mRebind)
+			{
+				if(mReadHeader)
+					mReader->reset(begin, end, uCSV::readHeader);
+				else
+					mReader->reset(begin, end, uCSV::ignoreHeader);
+			}
+			mRebind = false;
+			while(!mReader->done())
+			{
+				std::optional<Deserializer> row = mReader->fetch();
+				if(!row)
+					continue;
+				++result;
+				++mDelivered;
+				callback(*row);
+			}
+
+			// everything up to the end of the last complete record has been consumed
+			buffer.data.erase(0, static_cast<std::size_t>(buffer.complete - buffer.base));
+			buffer.base = buffer.complete;
+			return result;
+		}
+
+		void wait(std::chrono::milliseconds timeout)
+		{
+			// the path is checked regularly even with inotify, since a rotation replaces the watched file
+			timeout = std::min(timeout, std::chrono::milliseconds(250));
+#ifdef UCSV_FOLLOW_INOTIFY
+			if(mWatch >= 0)
+			{
+				::pollfd descriptor{ mNotify, POLLIN, 0 };
+				if(::poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0)
+				{
+					alignas(::inotify_event) char events[4096];
+					while(::read(mNotify, events, sizeof(events)) > 0);
+				}
+				return;
+			}
+#endif
+			std::this_thread::sleep_for(std::min(timeout, mPollInterval));
+		}
+	};
+}
+
+#endif // !UCSV_FOLLOW_HPP_INCLUDED
@@ -0,0 +1,491 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_JOIN_HPP_INCLUDED
+#define UCSV_JOIN_HPP_INCLUDED
+
+#include <uCSV.hpp>
+#include <uCSV/Sort.hpp>
+#include <uCSV/Spill.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+namespace uCSV
+{
+	enum class JoinType
+	{
+		inner,
+		left, // rows of the left input without a match are passed along with nullptr as the right row
+	};
+
+	struct JoinOptions
+	{
+		JoinType type = JoinType::inner;
+		std::size_t memory = std::size_t(256) << 20; // bytes of the right input held in memory at once by hashJoin
+		std::size_t partitions = 64; // files each input is split into once the right one exceeds memory
+		std::filesystem::path temporaryDirectory = {}; // empty picks the one of the system
+	};
+
+	struct JoinStatistics
+	{
+		std::size_t leftRows = 0;
+		std::size_t rightRows = 0;
+		std::size_t matches = 0; // pairs of joined rows
+		std::size_t unmatched = 0; // left rows passed along without a match by left joins
+		std::size_t partitions = 0; // pairs of partitions joined by hashJoin; 0 if the right input fit into memory
+	};
+
+	namespace Detail
+	{
+		// the right rows of a hash join, chained by the hashes of their keys
+		class JoinTable
+		{
+		public:
+			static constexpr std::size_t none = ~std::size_t(0);
+
+			explicit JoinTable(std::size_t keyColumn) noexcept
+				: mKeyColumn(keyColumn)
+			{
+			}
+
+			[[nodiscard]] SpillRows const& rows() const noexcept
+			{
+				return mRows;
+			}
+			// including the index built by finish
+			[[nodiscard]] std::size_t bytes() const noexcept
+			{
+				return mRows.bytes() + mRows.size() * 4 * sizeof(std::size_t);
+			}
+			void clear() noexcept
+			{
+				mRows.clear();
+				mHashes.clear();
+			}
+
+			void add(Deserializer const& row)
+			{
+				mRows.add(row);
+				mHashes.push_back(uCSV::hash(row.cell(mKeyColumn)));
+			}
+			bool read(std::ifstream& file)
+			{
+				if(!mRows.read(file))
+					return false;
+				mHashes.push_back(uCSV::hash(mRows.cell(mRows.size() - 1, mKeyColumn)));
+				return true;
+			}
+			void finish()
+			{
+				mRows.finish();
+				std::size_t buckets = 16;
+				while(buckets < mHashes.size() * 2)
+					buckets *= 2;
+				mHeads.assign(buckets, none);
+				mNext.assign(mHashes.size(), none);
+				// inserted backwards, so that the chains are in input order
+				for(std::size_t row = mHashes.size(); row-- > 0;)
+				{
+					std::size_t& head = mHeads[static_cast<std::size_t>(mHashes[row]) & (buckets - 1)];
+					mNext[row] = head;
+					head = row;
+				}
+			}
+			// calls match with the index of every row whose key equals key
+			template<typename MatchT>
+			void probe(string_view_t key, MatchT&& match) const
+			{
+				if(mHeads.empty())
+					return;
+				const std::uint64_t hash = uCSV::hash(key);
+				for(std::size_t row = mHeads[static_cast<std::size_t>(hash) & (mHeads.size() - 1)]; row != none; row = mNext[row])
+					if(mHashes[row] == hash && mRows.cell(row, mKeyColumn) == key)
+						match(row);
+			}
+
+		private:
+			std::size_t mKeyColumn;
+			SpillRows mRows;
+			std::vector<std::uint64_t> mHashes;
+			std::vector<std::size_t> mHeads;
+			std::vector<std::size_t> mNext;
+		};
+
+		// the partitioned hash join: both inputs are split into files by the hashes of their keys, so that the right part
+		// of every partition fits into memory. partitions which still don't fit, e.g. because of a skewed key distribution,
+		// are split again with another hash, up to maxLevels times
+		template<typename CallbackT>
+		class HashJoin
+		{
+		public:
+			static constexpr std::size_t maxLevels = 3;
+
+			HashJoin(std::size_t leftKey, std::size_t rightKey, CallbackT& callback, JoinOptions const& options, std::vector<string_t> leftHeader, std::vector<string_t> rightHeader)
+				: mLeftKey(leftKey), mRightKey(rightKey), mCallback(callback), mOptions(options), mFiles(options.temporaryDirectory),
+				mLeftHeader(std::move(leftHeader)), mRightHeader(std::move(rightHeader))
+			{
+				mOptions.partitions = std::max<std::size_t>(mOptions.partitions, 2);
+			}
+
+			template<typename LeftReaderT, typename RightReaderT>
+			JoinStatistics run(LeftReaderT& left, RightReaderT& right)
+			{
+				JoinTable table(mRightKey);
+				bool fits = true;
+				while(fits && !right.done())
+				{
+					std::optional<Deserializer> row = right.fetch();
+					if(!row)
+						continue;
+					if(const std::optional<string_view_t> key = keyOf(*row, mRightKey, mResult.rightRows))
+					{
+						table.add(*row);
+						fits = table.bytes() <= mOptions.memory;
+					}
+				}
+				if(fits)
+				{
+					table.finish();
+					while(!left.done())
+						if(std::optional<Deserializer> row = left.fetch())
+							probe(*row, keyOf(*row, mLeftKey, mResult.leftRows), table);
+					return mResult;
+				}
+
+				const std::vector<std::filesystem::path> rightPaths = createPartitions();
+				{
+					SpillPartitions files(rightPaths);
+					for(std::size_t i = 0; i < table.rows().size(); ++i)
+						table.rows().write(files[partition(table.rows().cell(i, mRightKey), 0)], i);
+					table.clear();
+					while(!right.done())
+						if(std::optional<Deserializer> row = right.fetch())
+							if(const std::optional<string_view_t> key = keyOf(*row, mRightKey, mResult.rightRows))
+								writeSpillRow(files[partition(*key, 0)], *row);
+					files.flush();
+				}
+				const std::vector<std::filesystem::path> leftPaths = createPartitions();
+				{
+					SpillPartitions files(leftPaths);
+					while(!left.done())
+					{
+						std::optional<Deserializer> row = left.fetch();
+						if(!row)
+							continue;
+						if(const std::optional<string_view_t> key = keyOf(*row, mLeftKey, mResult.leftRows))
+							writeSpillRow(files[partition(*key, 0)], *row);
+						else
+							probe(*row, std::nullopt, table);
+					}
+					files.flush();
+				}
+				joinPartitions(rightPaths, leftPaths, 1);
+				return mResult;
+			}
+
+		private:
+			std::size_t mLeftKey;
+			std::size_t mRightKey;
+			CallbackT& mCallback;
+			JoinOptions mOptions;
+			TemporaryFiles mFiles;
+			std::vector<string_t> mLeftHeader;
+			std::vector<string_t> mRightHeader;
+			JoinStatistics mResult;
+
+			// counts the row. empty keys never match
+			[[nodiscard]] static std::optional<string_view_t> keyOf(Deserializer const& row, std::size_t column, std::size_t& rows)
+			{
+				if(column >= row.total())
+					throw std::out_of_range("uCSV::hashJoin: the key column doesn't exist");
+				++rows;
+				const string_view_t key = row.cell(column);
+				if(key.empty())
+					return std::nullopt;
+				return key;
+			}
+			// the levels use different seeds than JoinTable, so that the rows of a partition don't share their buckets
+			[[nodiscard]] std::size_t partition(string_view_t key, std::size_t level) const noexcept
+			{
+				return static_cast<std::size_t>(uCSV::hash(key, level + 1) % mOptions.partitions);
+			}
+			[[nodiscard]] std::vector<std::filesystem::path> createPartitions()
+			{
+				std::vector<std::filesystem::path> paths;
+				for(std::size_t i = 0; i < mOptions.partitions; ++i)
+					paths.push_back(mFiles.create());
+				return paths;
+			}
+			void probe(Deserializer const& row, std::optional<string_view_t> key, JoinTable const& table)
+			{
+				bool matched = false;
+				if(key)
+				{
+					table.probe(*key, [&](std::size_t index)
+					{
+						Deserializer left = row;
+						Deserializer right = table.rows().row(index, mRightHeader);
+						mCallback(left, &right);
+						++mResult.matches;
+						matched = true;
+					});
+				}
+				if(!matched && mOptions.type == JoinType::left)
+				{
+					Deserializer left = row;
+					mCallback(left, static_cast<Deserializer*>(nullptr));
+					++mResult.unmatched;
+				}
+			}
+
+			void joinPartitions(std::vector<std::filesystem::path> const& rightPaths, std::vector<std::filesystem::path> const& leftPaths, std::size_t level)
+			{
+				for(std::size_t i = 0; i < rightPaths.size(); ++i)
+				{
+					joinPartition(rightPaths[i], leftPaths[i], level);
+					mFiles.remove(rightPaths[i]);
+					mFiles.remove(leftPaths[i]);
+				}
+			}
+			void joinPartition(std::filesystem::path const& rightPath, std::filesystem::path const& leftPath, std::size_t level)
+			{
+				++mResult.partitions;
+				JoinTable table(mRightKey);
+				std::ifstream rightFile(rightPath, std::ifstream::binary);
+				std::ifstream leftFile(leftPath, std::ifstream::binary);
+				if(!rightFile || !leftFile)
+					throw std::runtime_error("uCSV::hashJoin: failed to open a temporary file");
+				bool fits = true;
+				while(fits && table.read(rightFile))
+					fits = level >= maxLevels || table.bytes() <= mOptions.memory;
+
+				SpillRows row;
+				if(fits)
+				{
+					table.finish();
+					while(row.clear(), row.read(leftFile))
+					{
+						row.finish();
+						probe(row.row(0, mLeftHeader), row.cell(0, mLeftKey), table);
+					}
+					return;
+				}
+
+				const std::vector<std::filesystem::path> rightPaths = createPartitions();
+				{
+					SpillPartitions files(rightPaths);
+					for(std::size_t i = 0; i < table.rows().size(); ++i)
+						table.rows().write(files[partition(table.rows().cell(i, mRightKey), level)], i);
+					table.clear();
+					while(row.clear(), row.read(rightFile))
+						row.write(files[partition(row.cell(0, mRightKey), level)], 0);
+					files.flush();
+				}
+				const std::vector<std::filesystem::path> leftPaths = createPartitions();
+				{
+					SpillPartitions files(leftPaths);
+					while(row.clear(), row.read(leftFile))
+						row.write(files[partition(row.cell(0, mLeftKey), level)], 0);
+					files.flush();
+				}
+				// the partition itself is replaced by its parts
+				--mResult.partitions;
+				joinPartitions(rightPaths, leftPaths, level + 1);
+			}
+		};
+
+		// the key of a merge join. the string of value points into strings
+		struct JoinKey
+		{
+			SortValue value;
+			string_t strings;
+
+			// empty cells are nulls, which never match
+			void assign(SortKeyExtractor const& extractor, Deserializer const& row, std::size_t column)
+			{
+				if(column >= row.total())
+					throw std::out_of_range("uCSV::mergeJoin: the key column doesn't exist");
+				strings.clear();
+				extractor.extract(row, &value, strings);
+				extractor.resolve(&value, 1, strings);
+				value.null = value.null || row.cell(column).empty();
+			}
+			void copy(JoinKey const& other)
+			{
+				value = other.value;
+				strings = other.strings;
+				value.string = string_view_t(strings.data() + value.offset, value.size);
+			}
+		};
+	}
+
+	// joins the rows of left with those of right whose cells in the key columns are equal. both inputs have to be
+	// sorted by their keys, e.g. by externalSort with the same SortKey, which have to agree on type and direction; the
+	// order is verified and violations throw. callback is invoked as callback(Deserializer& left, Deserializer* right)
+	// for every pair of matching rows in the order of the inputs. both inputs are read once and only the right rows of
+	// the current key are held in memory. empty cells and cells which can't be converted to the type of the keys never
+	// match
+	template<typename LeftReaderT, typename RightReaderT, typename CallbackT>
+	JoinStatistics mergeJoin(LeftReaderT& left, RightReaderT& right, SortKey const& leftKey, SortKey const& rightKey, CallbackT&& callback, JoinType type = JoinType::inner)
+	{
+		if(leftKey.type != rightKey.type || leftKey.descending != rightKey.descending)
+			throw std::invalid_argument("uCSV::mergeJoin: the keys have to agree on type and direction");
+
+		JoinStatistics result;
+		const SortKeys leftKeys = { leftKey };
+		const SortKeys rightKeys = { rightKey };
+		const Detail::SortKeyExtractor leftExtractor(leftKeys);
+		const Detail::SortKeyExtractor rightExtractor(rightKeys);
+		const auto compare = [&leftExtractor](Detail::JoinKey const& lhs, Detail::JoinKey const& rhs)
+		{
+			return leftExtractor.compare(&lhs.value, &rhs.value);
+		};
+		const std::vector<string_t> rightHeader = Detail::headerNames(right);
+
+		// pending is the next right row with a key, which is rightValue
+		std::optional<Deserializer> pending;
+		Detail::JoinKey rightValue;
+		Detail::JoinKey candidate;
+		bool anyRight = false;
+		const auto advance = [&]
+		{
+			for(pending.reset(); !right.done();)
+			{
+				std::optional<Deserializer> row = right.fetch();
+				if(!row)
+					continue;
+				++result.rightRows;
+				candidate.assign(rightExtractor, *row, rightKey.column);
+				if(candidate.value.null)
+					continue;
+				if(anyRight && compare(candidate, rightValue) < 0)
+					throw std::runtime_error("uCSV::mergeJoin: the right input isn't sorted");
+				anyRight = true;
+				rightValue.copy(candidate);
+				pending = row;
+				return;
+			}
+		};
+
+		// the right rows whose key is groupValue
+		Detail::SpillRows group;
+		Detail::JoinKey groupValue;
+		bool grouped = false;
+		Detail::JoinKey leftValue;
+		Detail::JoinKey previousLeft;
+		bool anyLeft = false;
+		advance();
+		while(!left.done())
+		{
+			std::optional<Deserializer> row = left.fetch();
+			if(!row)
+				continue;
+			++result.leftRows;
+			leftValue.assign(leftExtractor, *row, leftKey.column);
+			bool matched = false;
+			if(!leftValue.value.null)
+			{
+				if(anyLeft && compare(leftValue, previousLeft) < 0)
+					throw std::runtime_error("uCSV::mergeJoin: the left input isn't sorted");
+				anyLeft = true;
+				previousLeft.copy(leftValue);
+
+				while(!grouped || compare(groupValue, leftValue) < 0)
+				{
+					grouped = false;
+					while(pending && compare(rightValue, leftValue) < 0)
+						advance();
+					if(!pending)
+						break;
+					group.clear();
+					groupValue.copy(rightValue);
+					do
+					{
+						group.add(*pending);
+						advance();
+					}
+					while(pending && compare(rightValue, groupValue) == 0);
+					group.finish();
+					grouped = true;
+				}
+				if(grouped && compare(groupValue, leftValue) == 0)
+				{
+					for(std::size_t i = 0; i < group.size(); ++i)
+					{
+						Deserializer leftRow = *row;
+						Deserializer rightRow = group.row(i, rightHeader);
+						callback(leftRow, &rightRow);
+					}
+					result.matches += group.size();
+					matched = true;
+				}
+			}
+			if(!matched && type == JoinType::left)
+			{
+				Deserializer leftRow = *row;
+				callback(leftRow, static_cast<Deserializer*>(nullptr));
+				++result.unmatched;
+			}
+		}
+		return result;
+	}
+
+	// joins the rows of left with those of right whose cells in the key columns are equal byte for byte, in any order.
+	// callback is invoked like by mergeJoin. the right input, usually the smaller one, is loaded into a hash table and
+	// the left one is streamed past it, which keeps the order of the left rows. if the right input exceeds
+	// options.memory, both are instead partitioned into temporary files by the hashes of their keys and joined partition
+	// by partition; the output is then grouped by partition. empty cells never match
+	template<typename LeftReaderT, typename RightReaderT, typename CallbackT>
+	JoinStatistics hashJoin(LeftReaderT& left, RightReaderT& right, std::size_t leftKey, std::size_t rightKey, CallbackT&& callback, JoinOptions const& options = {})
+	{
+		Detail::HashJoin<std::remove_reference_t<CallbackT>> join(leftKey, rightKey, callback, options, Detail::headerNames(left), Detail::headerNames(right));
+		return join.run(left, right);
+	}
+
+	// a callback for the joins which writes the joined rows as CSV records: the cells of the left row followed by those
+	// of the right one. for left rows without a match, rightColumns empty cells are written instead
+	class JoinWriter
+	{
+	public:
+		JoinWriter(std::ostream& output, std::size_t rightColumns) noexcept
+			: mOutput(&output), mRightColumns(rightColumns)
+		{
+		}
+
+		void operator()(Deserializer const& left, Deserializer const* right)
+		{
+			for(std::size_t i = 0; i < left.total(); ++i)
+			{
+				if(i > 0)
+					mOutput->put(',');
+				write(left.cell(i));
+			}
+			for(std::size_t i = 0; i < (right ? right->total() : mRightColumns); ++i)
+			{
+				mOutput->put(',');
+				if(right)
+					write(right->cell(i));
+			}
+			mOutput->put('\n');
+		}
+
+	private:
+		std::ostream* mOutput;
+		std::size_t mRightColumns;
+
+		void write(string_view_t cell)
+		{
+			if(needsEscaping(cell))
+				escape(cell, std::ostreambuf_iterator<char_t>(*mOutput));
+			else
+				mOutput->write(cell.data(), static_cast<std::streamsize>(cell.size()));
+		}
+	};
+}
+
+#endif // !UCSV_JOIN_HPP_INCLUDED
@@ -0,0 +1,267 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_KEYEDTABLE_HPP_INCLUDED
+#define UCSV_KEYEDTABLE_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+
+namespace uCSV
+{
+	// hashes keys for KeyedTable. strings are hashed by their bytes, so that string_t keys can be looked up by
+	// string_view_t without allocating; other keys are hashed by std::hash, whose result is mixed since it is often the
+	// identity
+	struct KeyHash
+	{
+		[[nodiscard]] std::uint64_t operator()(string_view_t key) const noexcept
+		{
+			return uCSV::hash(key);
+		}
+		template<typename T, typename = std::enable_if_t<!std::is_convertible_v<T const&, string_view_t>>>
+		[[nodiscard]] std::uint64_t operator()(T const& key) const noexcept
+		{
+			std::uint64_t x = static_cast<std::uint64_t>(std::hash<T>()(key));
+			// the finalizer of MurmurHash3
+			x ^= x >> 33;
+			x *= 0xFF51AFD7ED558CCDull;
+			x ^= x >> 33;
+			x *= 0xC4CEB9FE1A85EC53ull;
+			x ^= x >> 33;
+			return x;
+		}
+	};
+
+	namespace Detail
+	{
+		// allocates from the heap like std::allocator, but constructs its elements with an arena like a
+		// std::pmr::polymorphic_allocator. a vector of std::pmr types which uses it keeps their contents in the arena, while
+		// the buffers it outgrows are freed
+		template<typename T>
+		struct ArenaConstructAllocator
+		{
+			using value_type = T;
+
+			std::pmr::memory_resource* arena;
+
+			explicit ArenaConstructAllocator(std::pmr::memory_resource* resource) noexcept
+				: arena(resource)
+			{
+			}
+			template<typename U>
+			ArenaConstructAllocator(ArenaConstructAllocator<U> const& other) noexcept
+				: arena(other.arena)
+			{
+			}
+
+			[[nodiscard]] T* allocate(std::size_t n)
+			{
+				return std::allocator<T>().allocate(n);
+			}
+			void deallocate(T* p, std::size_t n) noexcept
+			{
+				std::allocator<T>().deallocate(p, n);
+			}
+			template<typename U, typename... Args>
+			void construct(U* p, Args&&... args)
+			{
+				std::pmr::polymorphic_allocator<U>(arena).construct(p, std::forward<Args>(args)...);
+			}
+
+			template<typename U>
+			[[nodiscard]] friend bool operator==(ArenaConstructAllocator const& lhs, ArenaConstructAllocator<U> const& rhs) noexcept
+			{
+				return lhs.arena == rhs.arena;
+			}
+			template<typename U>
+			[[nodiscard]] friend bool operator!=(ArenaConstructAllocator const& lhs, ArenaConstructAllocator<U> const& rhs) noexcept
+			{
+				return lhs.arena != rhs.arena;
+			}
+		};
+	}
+
+	// rows of a CSV file indexed by one of their cells, e.g. a dimension table for enrichment joins. it is built in a
+	// single pass while reading: the rows are stored in one vector and indexed by a flat open addressing table that holds
+	// the hashes of the keys, so that most lookups touch a single cache line besides the row. the cells of the rows and
+	// keys are packed into an arena, a std::pmr::monotonic_buffer_resource that is freed all at once, if they are std::pmr
+	// types, e.g. those of a KeyedTable<std::pmr::string, std::tuple<std::pmr::string, int>>. the vectors of the rows and
+	// keys themselves grow on the heap, since an arena would keep every buffer they outgrow. the table
+	// can't be modified once it has been built, hence any number of threads may look up rows concurrently without
+	// locking
+	template<typename KeyT, typename RowT, typename HashT = KeyHash>
+	class KeyedTable
+	{
+	public:
+		using KeyType = KeyT;
+		using RowType = RowT;
+		using HashType = HashT;
+		using RowVector = std::vector<RowType, Detail::ArenaConstructAllocator<RowType>>;
+		using KeyVector = std::vector<KeyType, Detail::ArenaConstructAllocator<KeyType>>;
+
+		KeyedTable()
+			: mStorage(std::make_unique<Storage>())
+		{
+		}
+		// reads all rows of reader. the key of a row is deserialized from the cell keyColumn, the row from all of its cells.
+		// bad rows are reported through the error handler of the reader and skipped; a duplicate key throws
+		template<typename ReaderT>
+		KeyedTable(ReaderT& reader, std::size_t keyColumn, HashType hash = HashType())
+			: mHash(std::move(hash)), mStorage(std::make_unique<Storage>()), mSlots(16)
+		{
+			RowVector& rows = mStorage->rows;
+			KeyVector& keys = mStorage->keys;
+			while(!reader.done())
+			{
+				std::optional<Deserializer> row = reader.fetch();
+				if(!row)
+					continue;
+				if(keyColumn >= row->total())
+					throw std::out_of_range("uCSV::KeyedTable: the key column doesn't exist");
+				string_view_t cell = row->cell(keyColumn);
+				Deserializer keyDeserializer(1, nullptr, &cell);
+				// the key and the row are constructed in place, so that their cells are in the arena
+				KeyType& key = keys.emplace_back();
+				try
+				{
+					deserialize(keyDeserializer, key);
+					if(probe(mHash(key), key).row != none)
+						throw std::runtime_error("uCSV::KeyedTable: duplicate key " + string_t(cell));
+					rows.emplace_back();
+				}
+				catch(...)
+				{
+					keys.pop_back();
+					throw;
+				}
+				try
+				{
+					deserialize(*row, rows.back());
+				}
+				catch(...)
+				{
+					rows.pop_back();
+					keys.pop_back();
+					throw;
+				}
+				insert(mHash(key), rows.size() - 1);
+			}
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept
+		{
+			return mStorage->rows.size();
+		}
+		[[nodiscard]] bool empty() const noexcept
+		{
+			return mStorage->rows.empty();
+		}
+		// the rows and keys in the order of the file
+		[[nodiscard]] RowVector const& rows() const noexcept
+		{
+			return mStorage->rows;
+		}
+		[[nodiscard]] KeyVector const& keys() const noexcept
+		{
+			return mStorage->keys;
+		}
+		// the arena the cells of the rows and keys are allocated from
+		[[nodiscard]] std::pmr::memory_resource* resource() const noexcept
+		{
+			return &mStorage->arena;
+		}
+
+		// nullptr if there is no row with key. key may be of any type that HashType hashes like KeyType and that compares
+		// equal to KeyType, e.g. string_view_t for string_t keys
+		template<typename K>
+		[[nodiscard]] RowType const* find(K const& key) const noexcept
+		{
+			if(empty())
+				return nullptr;
+			const std::size_t row = probe(mHash(key), key).row;
+			return row == none ? nullptr : &mStorage->rows[row];
+		}
+		template<typename K>
+		[[nodiscard]] bool contains(K const& key) const noexcept
+		{
+			return find(key) != nullptr;
+		}
+		template<typename K>
+		[[nodiscard]] RowType const& at(K const& key) const
+		{
+			RowType const* const row = find(key);
+			if(!row)
+				throw std::out_of_range("uCSV::KeyedTable::at: no such key");
+			return *row;
+		}
+
+	private:
+		static constexpr std::size_t none = ~std::size_t(0);
+
+		struct Slot
+		{
+			std::uint64_t hash = 0;
+			std::size_t row = none; // none marks an empty slot
+		};
+
+		// the vectors are declared after the arena, so that they're destroyed before it. the table owns them through a
+		// pointer, which keeps their allocators valid when the table is moved
+		struct Storage
+		{
+			std::pmr::monotonic_buffer_resource arena;
+			RowVector rows{ typename RowVector::allocator_type(&arena) };
+			KeyVector keys{ typename KeyVector::allocator_type(&arena) };
+		};
+
+		HashType mHash;
+		std::unique_ptr<Storage> mStorage;
+		std::vector<Slot> mSlots; // linear probing, the size is a power of two and at least twice the number of rows
+
+		template<typename K>
+		[[nodiscard]] Slot const& probe(std::uint64_t hash, K const& key) const noexcept
+		{
+			const std::size_t mask = mSlots.size() - 1;
+			for(std::size_t slot = static_cast<std::size_t>(hash) & mask;; slot = (slot + 1) & mask)
+			{
+				Slot const& candidate = mSlots[slot];
+				if(candidate.row == none || (candidate.hash == hash && mStorage->keys[candidate.row] == key))
+					return candidate;
+			}
+		}
+		void insert(std::uint64_t hash, std::size_t row)
+		{
+			if(mStorage->rows.size() * 2 > mSlots.size())
+			{
+				std::vector<Slot> old(mSlots.size() * 2);
+				old.swap(mSlots);
+				for(Slot const& slot : old)
+					if(slot.row != none)
+						place(slot);
+			}
+			place({ hash, row });
+		}
+		void place(Slot slot) noexcept
+		{
+			const std::size_t mask = mSlots.size() - 1;
+			std::size_t index = static_cast<std::size_t>(slot.hash) & mask;
+			while(mSlots[index].row != none)
+				index = (index + 1) & mask;
+			mSlots[index] = slot;
+		}
+	};
+
+	template<typename KeyT, typename RowT, typename ReaderT>
+	[[nodiscard]] KeyedTable<KeyT, RowT> keyedTable(ReaderT& reader, std::size_t keyColumn)
+	{
+		return KeyedTable<KeyT, RowT>(reader, keyColumn);
+	}
+}
+
+#endif // !UCSV_KEYEDTABLE_HPP_INCLUDED
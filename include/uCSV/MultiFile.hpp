@@ -0,0 +1,206 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_MULTIFILE_HPP_INCLUDED
+#define UCSV_MULTIFILE_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+namespace uCSV
+{
+	// reads a list of files as if they were one. a single Reader is reset onto every file, so its buffers are reused, and
+	// the next file is loaded on a background thread while the current one is being parsed. HeaderT is one of readHeader
+	// (every file has its own header), ignoreHeader, keepHeader (all files share the header of the first one) and
+	// verifyHeader (like keepHeader, but a file with a different header throws)
+	template<typename ErrorHandlerT = ErrorIgnore, typename DelimiterMatcherT = DefaultDelimiter, typename EncodingT = RawEncoding>
+	class MultiFileReader
+	{
+	public:
+		using ErrorHandlerType = ErrorHandlerT;
+		using DelimiterMatcherType = DelimiterMatcherT;
+		using EncodingType = EncodingT;
+		using ReaderType = Reader<char_t const*, ErrorHandlerType, DelimiterMatcherType, char_t const*, EncodingType>;
+
+		template<typename HeaderT>
+		MultiFileReader(std::vector<std::filesystem::path> paths, HeaderT header)
+			: MultiFileReader(std::move(paths), ErrorHandlerType(), DelimiterMatcherType(), header)
+		{
+		}
+		template<typename HeaderT>
+		MultiFileReader(std::vector<std::filesystem::path> paths, ErrorHandlerType errorHandler, HeaderT header)
+			: MultiFileReader(std::move(paths), std::move(errorHandler), DelimiterMatcherType(), header)
+		{
+		}
+		template<typename HeaderT>
+		MultiFileReader(std::vector<std::filesystem::path> paths, ErrorHandlerType errorHandler, DelimiterMatcherType delimiterMatcher, HeaderT)
+			: mPaths(std::move(paths)), mErrorHandler(std::move(errorHandler)), mDelimiterMatcher(std::move(delimiterMatcher))
+		{
+			static_assert(
+				std::is_same_v<HeaderT, std::true_type> || std::is_same_v<HeaderT, std::false_type>
+					|| std::is_same_v<HeaderT, KeepHeader> || std::is_same_v<HeaderT, VerifyHeader>,
+				"unsupported header policy"
+			);
+			if constexpr(std::is_same_v<HeaderT, std::true_type>)
+				mHeaderPolicy = HeaderPolicy::read;
+			else if constexpr(std::is_same_v<HeaderT, std::false_type>)
+				mHeaderPolicy = HeaderPolicy::ignore;
+			else if constexpr(std::is_same_v<HeaderT, KeepHeader>)
+				mHeaderPolicy = HeaderPolicy::keep;
+			else
+				mHeaderPolicy = HeaderPolicy::verify;
+			prefetch();
+		}
+		MultiFileReader(MultiFileReader const&) = delete;
+		MultiFileReader& operator=(MultiFileReader const&) = delete;
+		~MultiFileReader()
+		{
+			if(mPrefetch.valid())
+				mPrefetch.wait();
+		}
+
+		// the reader of the current file; std::nullopt before the first file has been opened
+		[[nodiscard]] std::optional<ReaderType> const& reader() const noexcept
+		{
+			return mReader;
+		}
+		[[nodiscard]] ErrorHandlerType& errorHandler() noexcept
+		{
+			return mReader ? mReader->errorHandler() : mErrorHandler;
+		}
+		// index of the current file
+		[[nodiscard]] std::size_t file() const noexcept
+		{
+			return mFile;
+		}
+		[[nodiscard]] std::filesystem::path const& path() const noexcept
+		{
+			assert(mFile < mPaths.size());
+			return mPaths[mFile];
+		}
+
+		// opens the next file if the current one has been read completely, which is why this isn't const. throws if a file
+		// can't be read
+		[[nodiscard]] bool done()
+		{
+			while((!mReader || mReader->done()) && advance());
+			return !mReader || mReader->done();
+		}
+
+		[[nodiscard]] std::optional<Deserializer> fetch()
+		{
+			if(done())
+				return std::nullopt;
+			return mReader->fetch();
+		}
+		template<typename RowT>
+		bool fetch(RowT& row)
+		{
+			if(done())
+				return false;
+			return mReader->fetch(row);
+		}
+		template<typename OutputIteratorT>
+		OutputIteratorT fetchAll(OutputIteratorT out)
+		{
+			using ValueT = iterator_value_t<OutputIteratorT>;
+			for(ValueT value; !done() && fetch(value); *out = std::move(value), ++out);
+			return out;
+		}
+
+	private:
+		enum class HeaderPolicy
+		{
+			read,
+			ignore,
+			keep,
+			verify,
+		};
+
+		std::vector<std::filesystem::path> mPaths;
+		ErrorHandlerType mErrorHandler; // only valid while there is no reader
+		DelimiterMatcherType mDelimiterMatcher;
+		HeaderPolicy mHeaderPolicy;
+
+		std::optional<ReaderType> mReader;
+		std::size_t mFile = 0;
+		std::size_t mLoaded = 0; // number of files loaded or being loaded
+		string_t mBuffers[2]; // the current file and the one being prefetched
+		std::size_t mCurrentBuffer = 1;
+		std::future<void> mPrefetch;
+
+		static void load(std::filesystem::path const& path, string_t& buffer)
+		{
+			std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+			if(!file.is_open())
+				throw std::runtime_error("uCSV::MultiFileReader: failed to open " + path.string());
+			const auto size = static_cast<std::size_t>(file.tellg());
+			file.seekg(0);
+			buffer.resize(size);
+			file.read(buffer.data(), static_cast<std::streamsize>(size));
+			if(static_cast<std::size_t>(file.gcount()) != size)
+				throw std::runtime_error("uCSV::MultiFileReader: failed to read " + path.string());
+		}
+		void prefetch()
+		{
+			if(mLoaded >= mPaths.size())
+				return;
+			string_t& buffer = mBuffers[1 - mCurrentBuffer];
+			std::filesystem::path const& path = mPaths[mLoaded++];
+			mPrefetch = std::async(std::launch::async, [&path, &buffer]{ load(path, buffer); });
+		}
+
+		// switches to the next file; returns false if there is none
+		bool advance()
+		{
+			if(!mPrefetch.valid())
+				return false;
+			mPrefetch.get();
+			const bool first = !mReader;
+			if(!first)
+				++mFile;
+			mCurrentBuffer = 1 - mCurrentBuffer;
+			string_t const& buffer = mBuffers[mCurrentBuffer];
+			char_t const* const begin = buffer.data();
+			char_t const* const end = begin + buffer.size();
+			if(first)
+			{
+				if(mHeaderPolicy == HeaderPolicy::ignore)
+					mReader.emplace(begin, end, std::move(mErrorHandler), mDelimiterMatcher, uCSV::ignoreHeader);
+				else
+					mReader.emplace(begin, end, std::move(mErrorHandler), mDelimiterMatcher, uCSV::readHeader);
+			}
+			else
+			{
+				switch(mHeaderPolicy)
+				{
+				case HeaderPolicy::read:
+					mReader->reset(begin, end, uCSV::readHeader);
+					break;
+				case HeaderPolicy::ignore:
+					mReader->reset(begin, end, uCSV::ignoreHeader);
+					break;
+				case HeaderPolicy::keep:
+					mReader->reset(begin, end, uCSV::keepHeader);
+					break;
+				case HeaderPolicy::verify:
+					if(!mReader->reset(begin, end, uCSV::verifyHeader))
+						throw std::runtime_error("uCSV::MultiFileReader: the header of " + mPaths[mFile].string() + " differs from the previous one");
+					break;
+				}
+			}
+			// the reader doesn't point into the other buffer anymore, so it can be overwritten
+			prefetch();
+			return true;
+		}
+	};
+}
+
+#endif // !UCSV_MULTIFILE_HPP_INCLUDED
@@ -0,0 +1,320 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_PIPELINE_HPP_INCLUDED
+#define UCSV_PIPELINE_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace uCSV
+{
+	struct PipelineOptions
+	{
+		std::size_t threads = 0; // conversion threads; 0 picks one less than the number of hardware threads
+		std::size_t batchRows = 1024; // rows per batch handed to a conversion thread
+		std::size_t maxBatches = 0; // batches scanned but not yet consumed; 0 picks 4 per conversion thread
+	};
+
+	namespace Detail
+	{
+		// a copy of the cells of consecutive rows; every cell is followed by a zero so that the conversions never read
+		// past a cell
+		class RowBatch
+		{
+		public:
+			std::size_t sequence = 0;
+
+			void clear() noexcept
+			{
+				mBytes.clear();
+				mCellEnds.clear();
+				mRowEnds.clear();
+				mCells.clear();
+			}
+			void push(Deserializer const& row)
+			{
+				for(std::size_t i = 0; i < row.total(); ++i)
+				{
+					const string_view_t cell = row.cell(i);
+					mBytes.append(cell.data(), cell.size());
+					mCellEnds.push_back(mBytes.size());
+					mBytes.push_back('\0');
+				}
+				mRowEnds.push_back(mCellEnds.size());
+			}
+			[[nodiscard]] std::size_t rows() const noexcept
+			{
+				return mRowEnds.size();
+			}
+			[[nodiscard]] std::size_t bytes() const noexcept
+			{
+				return mBytes.size();
+			}
+
+			// has to be called once all rows have been pushed and before row() is used
+			void seal()
+			{
+				mCells.clear();
+				mCells.reserve(mCellEnds.size());
+				std::size_t last = 0;
+				for(const std::size_t end : mCellEnds)
+				{
+					mCells.emplace_back(mBytes.data() + last, end - last);
+					last = end + 1;
+				}
+			}
+			[[nodiscard]] Deserializer row(std::size_t index, string_t const* header) const
+			{
+				assert(index < rows() && mCells.size() == mCellEnds.size());
+				const std::size_t first = index == 0 ? 0 : mRowEnds[index - 1];
+				return Deserializer(mRowEnds[index] - first, header, mCells.data() + first);
+			}
+
+		private:
+			string_t mBytes;
+			std::vector<std::size_t> mCellEnds;
+			std::vector<std::size_t> mRowEnds; // index one past the last cell of every row
+			std::vector<string_view_t> mCells;
+		};
+
+		[[nodiscard]] inline std::size_t defaultThreads() noexcept
+		{
+			const unsigned hardware = std::thread::hardware_concurrency();
+			return hardware > 1 ? hardware - 1 : 1;
+		}
+	}
+
+	// parses a single input on one thread while a pool of threads converts the rows into RowT. the rows are delivered in
+	// input order. this scales with the cost of the conversions even for input that can only be read sequentially, such
+	// as pipes. bad rows are reported through the error handler of the reader (on the scanning thread) and skipped
+	template<typename RowT, typename ReaderT>
+	class Pipeline
+	{
+	public:
+		using RowType = RowT;
+		using ReaderType = ReaderT;
+
+		// reader must outlive the pipeline and mustn't be used while the pipeline exists
+		explicit Pipeline(ReaderType& reader, PipelineOptions options = {})
+			: mReader(reader), mOptions(options)
+		{
+			if(mOptions.threads == 0)
+				mOptions.threads = Detail::defaultThreads();
+			if(mOptions.batchRows == 0)
+				mOptions.batchRows = 1;
+			if(mOptions.maxBatches == 0)
+				mOptions.maxBatches = 4 * mOptions.threads;
+
+			if(mReader.hasHeader())
+				for(std::size_t i = 0; i < mReader.columns(); ++i)
+					mHeader.emplace_back(mReader.header(i));
+
+			mWorkers.reserve(mOptions.threads);
+			for(std::size_t i = 0; i < mOptions.threads; ++i)
+				mWorkers.emplace_back([this]{ convert(); });
+			mScanner = std::thread([this]{ scan(); });
+		}
+		Pipeline(Pipeline const&) = delete;
+		Pipeline& operator=(Pipeline const&) = delete;
+		// waits for the scanning thread to finish the row it is currently reading
+		~Pipeline()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mStop = true;
+			}
+			mWork.notify_all();
+			mSpace.notify_all();
+			mScanner.join();
+			for(std::thread& worker : mWorkers)
+				worker.join();
+		}
+
+		// returns false once all rows have been delivered. exceptions thrown by the conversion of a row are rethrown here,
+		// in the place of that row
+		bool fetch(RowType& row)
+		{
+			for(;;)
+			{
+				if(mCurrent && mCurrentIndex < mCurrent->rows.size())
+				{
+					const std::size_t index = mCurrentIndex++;
+					if(mCurrentError < mCurrent->errors.size() && mCurrent->errors[mCurrentError].first == index)
+						std::rethrow_exception(mCurrent->errors[mCurrentError++].second);
+					row = std::move(mCurrent->rows[index]);
+					return true;
+				}
+
+				std::unique_lock<std::mutex> lock(mMutex);
+				if(mCurrent)
+				{
+					mCurrent.reset();
+					--mInFlight;
+					mSpace.notify_one();
+				}
+				mDone.wait(lock, [this]{ return mResults.count(mNext) > 0 || (mScanned && mNext == mBatches); });
+				auto found = mResults.find(mNext);
+				if(found == mResults.end())
+				{
+					if(mScanError)
+						std::rethrow_exception(std::exchange(mScanError, nullptr));
+					return false;
+				}
+				mCurrent = std::move(found->second);
+				mResults.erase(found);
+				++mNext;
+				mCurrentIndex = 0;
+				mCurrentError = 0;
+			}
+		}
+		template<typename OutputIteratorT>
+		OutputIteratorT fetchAll(OutputIteratorT out)
+		{
+			for(RowType row; fetch(row); *out = std::move(row), ++out);
+			return out;
+		}
+
+	private:
+		struct Result
+		{
+			std::vector<RowType> rows;
+			std::vector<std::pair<std::size_t, std::exception_ptr>> errors; // row index and what the conversion threw
+		};
+
+		ReaderType& mReader;
+		PipelineOptions mOptions;
+		std::vector<string_t> mHeader;
+
+		std::mutex mMutex;
+		std::condition_variable mWork; // signals workers that batches are available
+		std::condition_variable mSpace; // signals the scanner that fewer than maxBatches are in flight
+		std::condition_variable mDone; // signals the consumer that a batch has been converted
+		std::deque<Detail::RowBatch> mQueue;
+		std::vector<Detail::RowBatch> mSpare; // recycled batches, which keep their buffers
+		std::map<std::size_t, std::unique_ptr<Result>> mResults; // reorder buffer
+		std::size_t mBatches = 0; // batches emitted by the scanner
+		std::size_t mInFlight = 0;
+		std::size_t mNext = 0; // sequence number of the next batch to consume
+		bool mScanned = false;
+		bool mStop = false;
+		std::exception_ptr mScanError;
+
+		std::unique_ptr<Result> mCurrent;
+		std::size_t mCurrentIndex = 0;
+		std::size_t mCurrentError = 0;
+
+		std::thread mScanner;
+		std::vector<std::thread> mWorkers;
+
+		void scan()
+		{
+			Detail::RowBatch batch;
+			try
+			{
+				while(!mReader.done())
+				{
+					std::optional<Deserializer> row = mReader.fetch();
+					if(row)
+						batch.push(*row);
+					if(batch.rows() >= mOptions.batchRows && !emit(batch))
+						break;
+				}
+			}
+			catch(...)
+			{
+				// delivered after all rows preceding it
+				std::lock_guard<std::mutex> lock(mMutex);
+				mScanError = std::current_exception();
+			}
+			if(batch.rows() > 0)
+				emit(batch);
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mScanned = true;
+			}
+			mWork.notify_all();
+			mDone.notify_all();
+		}
+		// hands batch over to the workers and replaces it with an empty one. returns false if the pipeline is stopping
+		bool emit(Detail::RowBatch& batch)
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mSpace.wait(lock, [this]{ return mStop || mInFlight < mOptions.maxBatches; });
+			if(mStop)
+				return false;
+			batch.sequence = mBatches++;
+			++mInFlight;
+			mQueue.emplace_back(std::move(batch));
+			if(!mSpare.empty())
+			{
+				batch = std::move(mSpare.back());
+				mSpare.pop_back();
+			}
+			else
+				batch = Detail::RowBatch();
+			batch.clear();
+			lock.unlock();
+			mWork.notify_one();
+			return true;
+		}
+
+		void convert()
+		{
+			for(;;)
+			{
+				Detail::RowBatch batch;
+				{
+					std::unique_lock<std::mutex> lock(mMutex);
+					mWork.wait(lock, [this]{ return mStop || !mQueue.empty() || mScanned; });
+					if(mQueue.empty())
+						return;
+					batch = std::move(mQueue.front());
+					mQueue.pop_front();
+				}
+
+				batch.seal();
+				auto result = std::make_unique<Result>();
+				result->rows.resize(batch.rows());
+				string_t const* const header = mHeader.empty() ? nullptr : mHeader.data();
+				for(std::size_t i = 0; i < batch.rows(); ++i)
+				{
+					try
+					{
+						Deserializer deserializer = batch.row(i, header);
+						deserialize(deserializer, result->rows[i]);
+					}
+					catch(...)
+					{
+						result->errors.emplace_back(i, std::current_exception());
+					}
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(mMutex);
+					mResults.emplace(batch.sequence, std::move(result));
+					mSpare.emplace_back(std::move(batch));
+				}
+				mDone.notify_one();
+			}
+		}
+	};
+
+	template<typename RowT, typename ReaderT>
+	[[nodiscard]] Pipeline<RowT, ReaderT> pipeline(ReaderT& reader, PipelineOptions options = {})
+	{
+		return Pipeline<RowT, ReaderT>(reader, options);
+	}
+}
+
+#endif // !UCSV_PIPELINE_HPP_INCLUDED
@@ -0,0 +1,230 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_PROFILE_HPP_INCLUDED
+#define UCSV_PROFILE_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace uCSV
+{
+	// estimates the number of distinct values added to it in constant memory: 2^precision bytes, with a standard error
+	// of about 1.04 / sqrt(2^precision), i.e. 1.6% for the default precision
+	class HyperLogLog
+	{
+	public:
+		explicit HyperLogLog(unsigned int precision = 12)
+			: mPrecision(std::clamp(precision, 4u, 18u)), mRegisters(std::size_t(1) << mPrecision)
+		{
+		}
+
+		[[nodiscard]] unsigned int precision() const noexcept
+		{
+			return mPrecision;
+		}
+
+		// hash has to be uniformly distributed, e.g. one of uCSV::hash
+		void add(std::uint64_t hash) noexcept
+		{
+			const std::size_t index = static_cast<std::size_t>(hash >> (64 - mPrecision));
+			// the position of the first one bit of the remaining bits; the register index is shifted out
+			std::uint64_t rest = hash << mPrecision;
+			std::uint8_t rank = 1;
+			for(const std::uint8_t limit = static_cast<std::uint8_t>(64 - mPrecision + 1); rank < limit && !(rest >> 63); rest <<= 1)
+				++rank;
+			if(rank > mRegisters[index])
+				mRegisters[index] = rank;
+		}
+		// the estimate of both becomes that of the union of their values. the precisions have to be equal
+		void merge(HyperLogLog const& other)
+		{
+			if(other.mPrecision != mPrecision)
+				throw std::invalid_argument("uCSV::HyperLogLog::merge: the precisions differ");
+			for(std::size_t i = 0; i < mRegisters.size(); ++i)
+				mRegisters[i] = std::max(mRegisters[i], other.mRegisters[i]);
+		}
+		[[nodiscard]] double estimate() const noexcept
+		{
+			const double m = static_cast<double>(mRegisters.size());
+			double sum = 0;
+			std::size_t zeros = 0;
+			for(const std::uint8_t rank : mRegisters)
+			{
+				sum += std::ldexp(1.0, -static_cast<int>(rank));
+				zeros += rank == 0;
+			}
+			const double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+			// small cardinalities are counted more accurately by the empty registers
+			if(estimate <= 2.5 * m && zeros > 0)
+				return m * std::log(m / static_cast<double>(zeros));
+			return estimate;
+		}
+
+	private:
+		unsigned int mPrecision;
+		std::vector<std::uint8_t> mRegisters;
+	};
+
+	// the statistics of a column
+	struct ColumnProfile
+	{
+		std::uint64_t cells = 0;
+		std::uint64_t empty = 0;
+		std::uint64_t numeric = 0; // cells which are an integer or floating point number as a whole
+		double min = std::numeric_limits<double>::quiet_NaN(); // of the numeric cells
+		double max = std::numeric_limits<double>::quiet_NaN();
+		string_t minText; // bytewise, of the non-empty cells
+		string_t maxText;
+		std::size_t maxBytes = 0;
+		double distinct = 0; // the estimated number of distinct non-empty cells
+	};
+
+	struct ProfileOptions
+	{
+		unsigned int precision = 12; // of the distinct estimates, see HyperLogLog
+		std::size_t batchRows = 256; // rows whose hashes are buffered before the estimates are updated
+	};
+
+	// computes the statistics of the columns while a reader parses them, so that profiling doesn't take another pass.
+	// attach it to a reader, or feed it rows with add; then fetch or discard the rows as usual
+	class ColumnProfiler
+	{
+	public:
+		explicit ColumnProfiler(ProfileOptions const& options = {})
+			: mOptions(options)
+		{
+			mOptions.batchRows = std::max<std::size_t>(mOptions.batchRows, 1);
+		}
+
+		// the profiler mustn't be moved while it is attached
+		template<typename ReaderT>
+		void attach(ReaderT& reader)
+		{
+			reader.observeRows([this](string_view_t const* cells, std::size_t columns)
+			{
+				add(cells, columns);
+			});
+		}
+		template<typename ReaderT>
+		static void detach(ReaderT& reader)
+		{
+			reader.observeRows(nullptr);
+		}
+
+		// the cells have to be followed by a character which can't continue a number, as those of a Reader are
+		void add(string_view_t const* cells, std::size_t columns)
+		{
+			if(columns > mColumns.size())
+			{
+				mColumns.reserve(columns);
+				while(mColumns.size() < columns)
+					mColumns.emplace_back(mOptions.precision);
+			}
+			for(std::size_t i = 0; i < columns; ++i)
+				mColumns[i].add(cells[i]);
+			if(++mPending == mOptions.batchRows)
+				flush();
+			++mRows;
+		}
+		void add(Deserializer const& row)
+		{
+			for(std::size_t i = 0; i < row.total(); ++i)
+				mCells.push_back(row.cell(i));
+			add(mCells.data(), mCells.size());
+			mCells.clear();
+		}
+
+		[[nodiscard]] std::uint64_t rows() const noexcept
+		{
+			return mRows;
+		}
+		// the statistics of the rows added so far
+		[[nodiscard]] std::vector<ColumnProfile> profiles()
+		{
+			flush();
+			std::vector<ColumnProfile> result;
+			result.reserve(mColumns.size());
+			for(Column const& column : mColumns)
+			{
+				result.push_back(column.profile);
+				result.back().distinct = column.distinct.estimate();
+			}
+			return result;
+		}
+
+	private:
+		struct Column
+		{
+			ColumnProfile profile;
+			HyperLogLog distinct;
+			std::vector<std::uint64_t> hashes; // not yet added to distinct
+
+			explicit Column(unsigned int precision)
+				: distinct(precision)
+			{
+			}
+
+			void add(string_view_t cell)
+			{
+				++profile.cells;
+				if(cell.empty())
+				{
+					++profile.empty;
+					return;
+				}
+				profile.maxBytes = std::max(profile.maxBytes, cell.size());
+				if(profile.minText.empty() || cell < profile.minText)
+					profile.minText = cell;
+				if(cell > profile.maxText)
+					profile.maxText = cell;
+				hashes.push_back(uCSV::hash(cell));
+
+				double value;
+				if(number(cell, value))
+				{
+					++profile.numeric;
+					if(!(value >= profile.min))
+						profile.min = value;
+					if(!(value <= profile.max))
+						profile.max = value;
+				}
+			}
+			void flush()
+			{
+				for(const std::uint64_t hash : hashes)
+					distinct.add(hash);
+				hashes.clear();
+			}
+
+			// unlike deserialize, the whole cell has to be a finite number
+			[[nodiscard]] static bool number(string_view_t cell, double& value) noexcept
+			{
+				return Detail::convertCell(cell, value) && std::isfinite(value);
+			}
+
+		};
+
+		ProfileOptions mOptions;
+		std::vector<Column> mColumns;
+		std::vector<string_view_t> mCells;
+		std::size_t mPending = 0;
+		std::uint64_t mRows = 0;
+
+		void flush()
+		{
+			for(Column& column : mColumns)
+				column.flush();
+			mPending = 0;
+		}
+	};
+}
+
+#endif // !UCSV_PROFILE_HPP_INCLUDED
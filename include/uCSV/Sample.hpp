@@ -0,0 +1,292 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_SAMPLE_HPP_INCLUDED
+#define UCSV_SAMPLE_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <limits>
+#include <random>
+#include <unordered_set>
+
+namespace uCSV
+{
+	struct SampleOptions
+	{
+		std::size_t window = 1 << 20; // how far a record boundary is searched for from a random offset
+		std::size_t verifyRecords = 4; // records that have to be well-formed after a supposed boundary
+		std::size_t attemptsPerRow = 100; // random offsets per requested row before falling back to a full scan
+		double maxFailureRate = 0.5; // share of offsets without a unique boundary before falling back to a full scan
+	};
+
+	struct SampleStatistics
+	{
+		std::size_t rows = 0; // rows passed to the callback
+		std::size_t attempts = 0; // random offsets tried
+		std::size_t ambiguous = 0; // offsets which could be both inside and outside of quotes
+		std::size_t invalid = 0; // offsets near which no well-formed record was found
+		std::size_t rejected = 0; // records rejected to undo the bias towards long records
+		std::size_t duplicates = 0;
+		bool fullScan = false; // whether the sample had to be drawn by reading all of the input
+	};
+
+	namespace Detail
+	{
+		// finds and checks records of the default dialect around arbitrary positions without unescaping them
+		template<typename DelimiterMatcherT>
+		class RecordProbe
+		{
+		public:
+			RecordProbe(char_t const* first, char_t const* last, DelimiterMatcherT const& delimiterMatcher, std::size_t window) noexcept
+				: mFirst(first), mLast(last), mDelimiterMatcher(delimiterMatcher), mWindow(window)
+			{
+			}
+
+			// the end of the record containing position, given whether position is within quotes. nullptr if there is none
+			// within the window
+			[[nodiscard]] char_t const* next(char_t const* position, bool inQuotes) const noexcept
+			{
+				char_t const* const limit = static_cast<std::size_t>(mLast - position) > mWindow ? position + mWindow : mLast;
+				for(char_t const* p = position; p != limit; ++p)
+				{
+					if(*p == '"')
+						inQuotes = !inQuotes;
+					else if(!inQuotes && isNewline(*p))
+						return p + (*p == '\r' && p + 1 != mLast && p[1] == '\n' ? 2 : 1);
+				}
+				return limit == mLast && !inQuotes ? mLast : nullptr;
+			}
+			// the start of the record containing position, walking backwards while undoing the quoting state
+			[[nodiscard]] char_t const* previous(char_t const* position, bool inQuotes) const noexcept
+			{
+				char_t const* const limit = static_cast<std::size_t>(position - mFirst) > mWindow ? position - mWindow : mFirst;
+				for(char_t const* p = position; p != limit;)
+				{
+					--p;
+					if(*p == '"')
+						inQuotes = !inQuotes;
+					else if(!inQuotes && isNewline(*p))
+						return p + 1;
+				}
+				return limit == mFirst && !inQuotes ? mFirst : nullptr;
+			}
+			// whether the records starting at position are well-formed and have the given number of cells. the end of the
+			// input may come before the last of them
+			[[nodiscard]] bool verify(char_t const* position, std::size_t columns, std::size_t records) const noexcept
+			{
+				char_t const* const limit = static_cast<std::size_t>(mLast - position) > mWindow ? position + mWindow : mLast;
+				for(char_t const* p = position; records-- > 0 && p != mLast;)
+				{
+					if(p == limit || isNewline(*p))
+						return false;
+					std::size_t cells = 1;
+					for(;;)
+					{
+						if(p != limit && *p == '"')
+						{
+							for(++p;; ++p)
+							{
+								if(p == limit)
+									return false;
+								if(*p == '"')
+								{
+									if(p + 1 == limit || p[1] != '"')
+										break;
+									++p;
+								}
+							}
+							++p;
+							if(p != limit && !mDelimiterMatcher(*p) && !isNewline(*p))
+								return false;
+						}
+						else
+						{
+							for(; p != limit && !mDelimiterMatcher(*p) && !isNewline(*p); ++p)
+								if(*p == '"')
+									return false;
+						}
+						if(p == limit)
+						{
+							if(limit != mLast)
+								return false;
+							break;
+						}
+						if(mDelimiterMatcher(*p))
+						{
+							++cells;
+							++p;
+							continue;
+						}
+						p += *p == '\r' && p + 1 != mLast && p[1] == '\n' ? 2 : 1;
+						break;
+					}
+					if(cells != columns)
+						return false;
+				}
+				return true;
+			}
+			// the number of cells of the record at position; 0 if it isn't well-formed
+			[[nodiscard]] std::size_t columns(char_t const* position) const noexcept
+			{
+				char_t const* const end = next(position, false);
+				if(!end)
+					return 0;
+				for(std::size_t columns = 1;; ++columns)
+				{
+					if(verify(position, columns, 1))
+						return columns;
+					if(columns > static_cast<std::size_t>(end - position))
+						return 0;
+				}
+			}
+
+		private:
+			char_t const* mFirst;
+			char_t const* mLast;
+			DelimiterMatcherT const& mDelimiterMatcher;
+			std::size_t mWindow;
+		};
+	}
+
+	// passes about count rows, drawn uniformly at random without replacement, to callback as Deserializer&, in input
+	// order. instead of reading the input, it jumps to random offsets and searches for the surrounding record. since a
+	// newline may just as well be part of a quoted cell, both possibilities are checked by parsing the records around it;
+	// offsets where they can't be told apart are skipped. long records are hit more often, which is undone by keeping a
+	// record with the probability shortest / length, where shortest is the length of the shortest record found. whenever
+	// it drops, the records kept so far are tested again, so that all of them pass the same test and the ones that don't
+	// are replaced by further draws. if too many offsets fail, e.g. in tiny inputs, all of the input is read instead.
+	// reader has to read contiguous memory in the default dialect and be positioned at its first row; afterwards it is at
+	// the end
+	template<typename ReaderT, typename RngT, typename CallbackT>
+	SampleStatistics sample(ReaderT& reader, std::size_t count, RngT& rng, CallbackT&& callback, SampleOptions const& options = {})
+	{
+		static_assert(
+			std::is_same_v<typename ReaderT::InputIteratorBeginType, char_t const*> && std::is_same_v<typename ReaderT::InputIteratorEndType, char_t const*>,
+			"sampling requires a reader of contiguous memory"
+		);
+		static_assert(std::is_same_v<typename ReaderT::DialectType, DefaultDialect>, "sampling supports the default dialect only");
+
+		SampleStatistics result;
+		char_t const* const first = reader.position();
+		char_t const* const last = reader.endPosition();
+		if(count == 0 || first == last)
+			return result;
+
+		const Detail::RecordProbe probe(first, last, reader.delimiterMatcher(), options.window);
+		const std::size_t columns = reader.columns() != 0 ? reader.columns() : probe.columns(first);
+
+		struct Candidate
+		{
+			char_t const* start;
+			double weight; // the uniform draw times the length, which has to be at most the shortest length
+		};
+		std::vector<Candidate> candidates;
+		std::unordered_set<char_t const*> seen;
+		std::uniform_int_distribution<std::size_t> offsets(0, static_cast<std::size_t>(last - first) - 1);
+		std::uniform_real_distribution<double> unit(0, 1);
+		auto shortest = std::numeric_limits<std::ptrdiff_t>::max();
+		const std::size_t maxAttempts = count * options.attemptsPerRow;
+		while(columns != 0 && candidates.size() < count && result.attempts < maxAttempts)
+		{
+			const std::size_t failures = result.ambiguous + result.invalid;
+			if(result.attempts >= 64 && static_cast<double>(failures) > options.maxFailureRate * static_cast<double>(result.attempts))
+				break;
+			++result.attempts;
+
+			char_t const* position = first + offsets(rng);
+			// the \n of a \r\n belongs to the same record as the \r
+			if(position != first && *position == '\n' && position[-1] == '\r')
+				--position;
+			std::size_t hypotheses = 0;
+			char_t const* start = nullptr;
+			char_t const* end = nullptr;
+			for(const bool inQuotes : { false, true })
+			{
+				char_t const* const begin = probe.previous(position, inQuotes);
+				char_t const* const next = begin ? probe.next(position, inQuotes) : nullptr;
+				if(next && probe.verify(begin, columns, options.verifyRecords))
+				{
+					++hypotheses;
+					start = begin;
+					end = next;
+				}
+			}
+			if(hypotheses != 1)
+			{
+				++(hypotheses == 0 ? result.invalid : result.ambiguous);
+				continue;
+			}
+
+			// the shortest record seen thus far stands in for the shortest record of the input
+			const std::ptrdiff_t length = end - start;
+			if(length < shortest)
+			{
+				shortest = length;
+				const auto rejected = std::remove_if(candidates.begin(), candidates.end(), [&seen, shortest](Candidate const& candidate)
+				{
+					if(candidate.weight <= static_cast<double>(shortest))
+						return false;
+					seen.erase(candidate.start);
+					return true;
+				});
+				result.rejected += static_cast<std::size_t>(candidates.end() - rejected);
+				candidates.erase(rejected, candidates.end());
+			}
+			const double weight = unit(rng) * static_cast<double>(length);
+			if(weight > static_cast<double>(shortest))
+			{
+				++result.rejected;
+				continue;
+			}
+			if(!seen.insert(start).second)
+			{
+				++result.duplicates;
+				continue;
+			}
+			candidates.push_back({ start, weight });
+		}
+
+		std::vector<char_t const*> starts;
+		starts.reserve(count);
+		for(Candidate const& candidate : candidates)
+			starts.push_back(candidate.start);
+		if(starts.size() < count)
+		{
+			// reservoir sampling over all records
+			result.fullScan = true;
+			starts.clear();
+			reader.seek(first);
+			for(std::size_t records = 0; !reader.done();)
+			{
+				char_t const* const start = reader.position();
+				if(!reader.fetch())
+					continue;
+				if(records < count)
+					starts.push_back(start);
+				else if(const std::size_t slot = std::uniform_int_distribution<std::size_t>(0, records)(rng); slot < count)
+					starts[slot] = start;
+				++records;
+			}
+		}
+
+		std::sort(starts.begin(), starts.end());
+		for(char_t const* const start : starts)
+		{
+			reader.seek(start);
+			if(std::optional<Deserializer> row = reader.fetch())
+			{
+				++result.rows;
+				callback(*row);
+			}
+		}
+		reader.seek(last);
+		return result;
+	}
+}
+
+#endif // !UCSV_SAMPLE_HPP_INCLUDED
@@ -0,0 +1,538 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_SIDECAR_HPP_INCLUDED
+#define UCSV_SIDECAR_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UCSV_SIDECAR_MMAP 1
+#endif
+
+// A sidecar is a binary columnar copy of a CSV file which can be mapped into memory directly. Layout (native byte order,
+// every section aligned to 64 bytes):
+//   FileHeader
+//   ColumnEntry[columns]
+//   column names
+//   per column: fixed-width values (int64, float64) or rows + 1 offsets into the string heap followed by the heap itself
+namespace uCSV
+{
+	struct SidecarColumn
+	{
+		std::size_t index; // index of the column in the CSV file
+		ColumnType type;
+		string_t name = {}; // taken from the header of the reader if empty
+	};
+	using SidecarSchema = std::vector<SidecarColumn>;
+
+	// identifies the version of a source file the sidecar was created from
+	struct SidecarKey
+	{
+		std::uint64_t size = 0;
+		std::int64_t mtime = 0;
+		std::uint64_t hash = 0;
+
+		// size and modification time only; cheap
+		[[nodiscard]] static SidecarKey stat(std::filesystem::path const& source)
+		{
+			SidecarKey result;
+			result.size = std::filesystem::file_size(source);
+			result.mtime = static_cast<std::int64_t>(std::filesystem::last_write_time(source).time_since_epoch().count());
+			return result;
+		}
+		// additionally hashes the whole contents of the file
+		[[nodiscard]] static SidecarKey of(std::filesystem::path const& source)
+		{
+			SidecarKey result = stat(source);
+			std::ifstream file(source, std::ifstream::binary);
+			if(!file.is_open())
+				throw std::runtime_error("uCSV::SidecarKey: failed to open " + source.string());
+			std::vector<char> chunk(1 << 20);
+			for(;;)
+			{
+				file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+				const auto read = static_cast<std::size_t>(file.gcount());
+				if(read == 0)
+					break;
+				result.hash = uCSV::hash(chunk.data(), read, result.hash);
+			}
+			return result;
+		}
+	};
+
+	namespace Detail
+	{
+		inline constexpr char sidecarMagic[8] = { 'u', 'C', 'S', 'V', 'S', 'C', 'A', 'R' };
+		inline constexpr std::uint32_t sidecarVersion = 1;
+		inline constexpr std::uint32_t sidecarByteOrder = 0x01020304;
+		inline constexpr std::uint64_t sidecarAlignment = 64;
+
+		struct SidecarFileHeader
+		{
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t byteOrder;
+			std::uint64_t columns;
+			std::uint64_t rows;
+			std::uint64_t sourceSize;
+			std::int64_t sourceMtime;
+			std::uint64_t sourceHash;
+		};
+		struct SidecarColumnEntry
+		{
+			ColumnType type;
+			std::uint64_t nameOffset;
+			std::uint64_t nameSize;
+			std::uint64_t dataOffset;
+			std::uint64_t dataSize;
+			std::uint64_t heapOffset;
+			std::uint64_t heapSize;
+		};
+
+		[[nodiscard]] constexpr std::uint64_t alignUp(std::uint64_t x, std::uint64_t alignment) noexcept
+		{
+			return (x + alignment - 1) / alignment * alignment;
+		}
+
+		// read-only view of a whole file; mapped where possible, read into memory otherwise
+		class MappedFile
+		{
+		public:
+			MappedFile() noexcept = default;
+			MappedFile(MappedFile&& other) noexcept
+				: mData(std::exchange(other.mData, nullptr)), mSize(std::exchange(other.mSize, 0)), mMapped(other.mMapped), mBuffer(std::move(other.mBuffer))
+			{
+			}
+			MappedFile& operator=(MappedFile&& other) noexcept
+			{
+				if(this != &other)
+				{
+					release();
+					mData = std::exchange(other.mData, nullptr);
+					mSize = std::exchange(other.mSize, 0);
+					mMapped = other.mMapped;
+					mBuffer = std::move(other.mBuffer);
+				}
+				return *this;
+			}
+			~MappedFile()
+			{
+				release();
+			}
+
+			// returns false if the file couldn't be opened
+			bool open(std::filesystem::path const& path)
+			{
+				release();
+#ifdef UCSV_SIDECAR_MMAP
+				const int fd = ::open(path.c_str(), O_RDONLY);
+				if(fd < 0)
+					return false;
+				struct ::stat info;
+				if(::fstat(fd, &info) != 0)
+				{
+					::close(fd);
+					return false;
+				}
+				mSize = static_cast<std::size_t>(info.st_size);
+				if(mSize > 0)
+				{
+					void* const address = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+					if(address == MAP_FAILED)
+					{
+						::close(fd);
+						mSize = 0;
+						return false;
+					}
+					mData = static_cast<char const*>(address);
+					mMapped = true;
+				}
+				::close(fd);
+				return true;
+#else
+				std::ifstream file(path, std::ifstream::binary | std::ifstream::ate);
+				if(!file.is_open())
+					return false;
+				mSize = static_cast<std::size_t>(file.tellg());
+				file.seekg(0);
+				// operator new[] guarantees an alignment sufficient for the fixed-width columns
+				mBuffer.reset(new char[mSize > 0 ? mSize : 1]);
+				file.read(mBuffer.get(), static_cast<std::streamsize>(mSize));
+				mData = mBuffer.get();
+				return static_cast<std::size_t>(file.gcount()) == mSize;
+#endif
+			}
+
+			[[nodiscard]] char const* data() const noexcept
+			{
+				return mData;
+			}
+			[[nodiscard]] std::size_t size() const noexcept
+			{
+				return mSize;
+			}
+
+		private:
+			char const* mData = nullptr;
+			std::size_t mSize = 0;
+			bool mMapped = false;
+			std::unique_ptr<char[]> mBuffer;
+
+			void release() noexcept
+			{
+#ifdef UCSV_SIDECAR_MMAP
+				if(mMapped)
+					::munmap(const_cast<char*>(mData), mSize);
+#endif
+				mData = nullptr;
+				mSize = 0;
+				mMapped = false;
+				mBuffer.reset();
+			}
+		};
+
+		class SidecarColumnBuilder
+		{
+		public:
+			explicit SidecarColumnBuilder(ColumnType type)
+				: mType(type)
+			{
+				if(mType == ColumnType::string)
+					mOffsets.push_back(0);
+			}
+
+			[[nodiscard]] ColumnType type() const noexcept
+			{
+				return mType;
+			}
+
+			// returns false if the cell couldn't be converted; a zero is stored in that case
+			bool push(string_view_t cell)
+			{
+				switch(mType)
+				{
+				case ColumnType::int64:
+				{
+					std::int64_t value = 0;
+					const bool good = Detail::convertCell(cell, value);
+					mInts.push_back(good ? value : 0);
+					return good;
+				}
+				case ColumnType::float64:
+				{
+					double value = 0;
+					const bool good = Detail::convertCell(cell, value);
+					mFloats.push_back(good ? value : 0);
+					return good;
+				}
+				case ColumnType::string:
+					mHeap.insert(mHeap.end(), cell.begin(), cell.end());
+					mOffsets.push_back(mHeap.size());
+					return true;
+				}
+				return false;
+			}
+
+			[[nodiscard]] std::uint64_t dataSize() const noexcept
+			{
+				switch(mType)
+				{
+				case ColumnType::int64:
+					return mInts.size() * sizeof(std::int64_t);
+				case ColumnType::float64:
+					return mFloats.size() * sizeof(double);
+				case ColumnType::string:
+					return mOffsets.size() * sizeof(std::uint64_t);
+				}
+				return 0;
+			}
+			[[nodiscard]] char const* data() const noexcept
+			{
+				switch(mType)
+				{
+				case ColumnType::int64:
+					return reinterpret_cast<char const*>(mInts.data());
+				case ColumnType::float64:
+					return reinterpret_cast<char const*>(mFloats.data());
+				case ColumnType::string:
+					return reinterpret_cast<char const*>(mOffsets.data());
+				}
+				return nullptr;
+			}
+			[[nodiscard]] std::uint64_t heapSize() const noexcept
+			{
+				return mHeap.size();
+			}
+			[[nodiscard]] char const* heap() const noexcept
+			{
+				return mHeap.data();
+			}
+
+		private:
+			ColumnType mType;
+			std::vector<std::int64_t> mInts;
+			std::vector<double> mFloats;
+			std::vector<std::uint64_t> mOffsets;
+			std::vector<char_t> mHeap;
+		};
+	}
+
+	// converts the remaining rows of reader into a sidecar file; bad rows are skipped and unconvertible numbers are
+	// reported as bad cells and stored as zero. returns the number of rows written
+	template<typename ReaderT>
+	std::size_t writeSidecar(ReaderT& reader, SidecarSchema const& schema, std::filesystem::path const& source, std::filesystem::path const& sidecar)
+	{
+		const SidecarKey key = SidecarKey::of(source);
+
+		std::vector<Detail::SidecarColumnBuilder> builders;
+		builders.reserve(schema.size());
+		for(SidecarColumn const& column : schema)
+			builders.emplace_back(column.type);
+
+		std::uint64_t rows = 0;
+		while(!reader.done())
+		{
+			std::optional<Deserializer> row = reader.fetch();
+			if(!row)
+				continue;
+			for(std::size_t i = 0; i < schema.size(); ++i)
+				if(!builders[i].push(row->cell(schema[i].index)))
+					reader.errorHandler().raiseBadCell(static_cast<unsigned int>(schema[i].index), static_cast<unsigned int>(reader.rows() - 1));
+			++rows;
+		}
+
+		std::vector<string_t> names;
+		names.reserve(schema.size());
+		for(SidecarColumn const& column : schema)
+			names.emplace_back(!column.name.empty() || !reader.hasHeader() ? column.name : string_t(reader.header(column.index)));
+
+		Detail::SidecarFileHeader header{};
+		std::copy(std::begin(Detail::sidecarMagic), std::end(Detail::sidecarMagic), header.magic);
+		header.version = Detail::sidecarVersion;
+		header.byteOrder = Detail::sidecarByteOrder;
+		header.columns = schema.size();
+		header.rows = rows;
+		header.sourceSize = key.size;
+		header.sourceMtime = key.mtime;
+		header.sourceHash = key.hash;
+
+		std::vector<Detail::SidecarColumnEntry> entries(schema.size());
+		std::uint64_t offset = sizeof(header) + entries.size() * sizeof(Detail::SidecarColumnEntry);
+		for(std::size_t i = 0; i < schema.size(); ++i)
+		{
+			entries[i].type = schema[i].type;
+			entries[i].nameOffset = offset;
+			entries[i].nameSize = names[i].size();
+			offset += names[i].size();
+		}
+		for(std::size_t i = 0; i < schema.size(); ++i)
+		{
+			offset = Detail::alignUp(offset, Detail::sidecarAlignment);
+			entries[i].dataOffset = offset;
+			entries[i].dataSize = builders[i].dataSize();
+			offset += entries[i].dataSize;
+			offset = Detail::alignUp(offset, Detail::sidecarAlignment);
+			entries[i].heapOffset = offset;
+			entries[i].heapSize = builders[i].heapSize();
+			offset += entries[i].heapSize;
+		}
+
+		// write to a temporary file first so that readers never observe a partially written sidecar
+		std::filesystem::path temporary = sidecar;
+		temporary += ".tmp";
+		{
+			std::ofstream file(temporary, std::ofstream::binary | std::ofstream::trunc);
+			if(!file.is_open())
+				throw std::runtime_error("uCSV::writeSidecar: failed to open " + temporary.string());
+			std::uint64_t position = 0;
+			const auto write = [&](char const* data, std::uint64_t size)
+			{
+				file.write(data, static_cast<std::streamsize>(size));
+				position += size;
+			};
+			const auto pad = [&](std::uint64_t target)
+			{
+				static constexpr char zeros[Detail::sidecarAlignment] = {};
+				assert(target >= position && target - position <= sizeof(zeros));
+				write(zeros, target - position);
+			};
+			write(reinterpret_cast<char const*>(&header), sizeof(header));
+			write(reinterpret_cast<char const*>(entries.data()), entries.size() * sizeof(Detail::SidecarColumnEntry));
+			for(string_t const& name : names)
+				write(name.data(), name.size());
+			for(std::size_t i = 0; i < schema.size(); ++i)
+			{
+				pad(entries[i].dataOffset);
+				write(builders[i].data(), entries[i].dataSize);
+				pad(entries[i].heapOffset);
+				write(builders[i].heap(), entries[i].heapSize);
+			}
+			if(!file)
+				throw std::runtime_error("uCSV::writeSidecar: failed to write " + temporary.string());
+		}
+		std::filesystem::rename(temporary, sidecar);
+		return static_cast<std::size_t>(rows);
+	}
+
+	// read-only view of a sidecar file. the file is mapped into memory, hence pages are only loaded once accessed
+	class Sidecar
+	{
+	public:
+		// returns std::nullopt if the sidecar doesn't exist or is malformed
+		[[nodiscard]] static std::optional<Sidecar> open(std::filesystem::path const& sidecar)
+		{
+			Sidecar result;
+			if(!result.mFile.open(sidecar) || !result.parse())
+				return std::nullopt;
+			return result;
+		}
+		// additionally returns std::nullopt if source has been modified since the sidecar was written. the modification is
+		// detected through size and modification time, or by hashing the whole source if verifyHash is set
+		[[nodiscard]] static std::optional<Sidecar> open(std::filesystem::path const& sidecar, std::filesystem::path const& source, bool verifyHash = false)
+		{
+			std::error_code ec;
+			if(!std::filesystem::exists(source, ec))
+				return std::nullopt;
+			std::optional<Sidecar> result = open(sidecar);
+			if(!result)
+				return std::nullopt;
+			const SidecarKey key = verifyHash ? SidecarKey::of(source) : SidecarKey::stat(source);
+			SidecarKey const& stored = result->key();
+			if(key.size != stored.size || key.mtime != stored.mtime || (verifyHash && key.hash != stored.hash))
+				return std::nullopt;
+			return result;
+		}
+
+		[[nodiscard]] SidecarKey const& key() const noexcept
+		{
+			return mKey;
+		}
+		[[nodiscard]] std::size_t rows() const noexcept
+		{
+			return mRows;
+		}
+		[[nodiscard]] std::size_t columns() const noexcept
+		{
+			return mEntries.size();
+		}
+		[[nodiscard]] ColumnType type(std::size_t column) const noexcept
+		{
+			assert(column < columns());
+			return mEntries[column].type;
+		}
+		[[nodiscard]] string_view_t name(std::size_t column) const noexcept
+		{
+			assert(column < columns());
+			return { mFile.data() + mEntries[column].nameOffset, static_cast<std::size_t>(mEntries[column].nameSize) };
+		}
+
+		// rows() values each
+		[[nodiscard]] std::int64_t const* int64s(std::size_t column) const
+		{
+			return values<std::int64_t>(column, ColumnType::int64);
+		}
+		[[nodiscard]] double const* float64s(std::size_t column) const
+		{
+			return values<double>(column, ColumnType::float64);
+		}
+		[[nodiscard]] string_view_t string(std::size_t column, std::size_t row) const
+		{
+			std::uint64_t const* const offsets = values<std::uint64_t>(column, ColumnType::string);
+			assert(row < rows());
+			const std::uint64_t begin = offsets[row], end = offsets[row + 1];
+			if(begin > end || end > mEntries[column].heapSize)
+				throw std::runtime_error("uCSV::Sidecar: corrupt string offsets in column " + std::to_string(column) + " and row " + std::to_string(row));
+			return { mFile.data() + mEntries[column].heapOffset + begin, static_cast<std::size_t>(end - begin) };
+		}
+
+	private:
+		Detail::MappedFile mFile;
+		SidecarKey mKey;
+		std::size_t mRows = 0;
+		std::vector<Detail::SidecarColumnEntry> mEntries;
+
+		Sidecar() = default;
+
+		template<typename T>
+		[[nodiscard]] T const* values(std::size_t column, ColumnType expected) const
+		{
+			if(column >= columns() || mEntries[column].type != expected)
+				throw std::invalid_argument("uCSV::Sidecar: column " + std::to_string(column) + " doesn't have the requested type");
+			return reinterpret_cast<T const*>(mFile.data() + mEntries[column].dataOffset);
+		}
+
+		bool parse()
+		{
+			const std::uint64_t size = mFile.size();
+			Detail::SidecarFileHeader header;
+			if(size < sizeof(header))
+				return false;
+			std::memcpy(&header, mFile.data(), sizeof(header));
+			if(!std::equal(std::begin(Detail::sidecarMagic), std::end(Detail::sidecarMagic), header.magic)
+				|| header.version != Detail::sidecarVersion
+				|| header.byteOrder != Detail::sidecarByteOrder
+				|| header.columns > (size - sizeof(header)) / sizeof(Detail::SidecarColumnEntry)
+				|| header.rows >= std::numeric_limits<std::size_t>::max()
+				// every value takes 8 bytes, hence the sizes below can't overflow
+				|| header.rows > (size - sizeof(header)) / 8)
+				return false;
+			mKey.size = header.sourceSize;
+			mKey.mtime = header.sourceMtime;
+			mKey.hash = header.sourceHash;
+			mRows = static_cast<std::size_t>(header.rows);
+
+			mEntries.resize(static_cast<std::size_t>(header.columns));
+			std::memcpy(mEntries.data(), mFile.data() + sizeof(header), mEntries.size() * sizeof(Detail::SidecarColumnEntry));
+			const auto fits = [size](std::uint64_t offset, std::uint64_t bytes) noexcept
+			{
+				return offset <= size && bytes <= size - offset;
+			};
+			for(Detail::SidecarColumnEntry const& entry : mEntries)
+			{
+				if(!fits(entry.nameOffset, entry.nameSize) || !fits(entry.dataOffset, entry.dataSize) || !fits(entry.heapOffset, entry.heapSize)
+					|| entry.dataOffset % Detail::sidecarAlignment != 0)
+					return false;
+				switch(entry.type)
+				{
+				case ColumnType::int64:
+				case ColumnType::float64:
+					if(entry.dataSize != header.rows * 8)
+						return false;
+					break;
+				case ColumnType::string:
+				{
+					if(entry.dataSize != (header.rows + 1) * sizeof(std::uint64_t))
+						return false;
+					// only the outer offsets are checked here, as reading all of them would load every page. string() checks
+					// the offsets it uses
+					std::uint64_t first, last;
+					std::memcpy(&first, mFile.data() + entry.dataOffset, sizeof(first));
+					std::memcpy(&last, mFile.data() + entry.dataOffset + header.rows * sizeof(std::uint64_t), sizeof(last));
+					if(first != 0 || last != entry.heapSize)
+						return false;
+					break;
+				}
+				default:
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+}
+
+#endif // !UCSV_SIDECAR_HPP_INCLUDED
@@ -0,0 +1,330 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_SNIFF_HPP_INCLUDED
+#define UCSV_SNIFF_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+namespace uCSV
+{
+	enum class LineEnding
+	{
+		lf,
+		crlf,
+		cr,
+	};
+
+	enum class CellType
+	{
+		integer,
+		floating,
+		timestamp, // YYYY-MM-DD[(T| )hh:mm:ss[.fffffffff][Z|±hh:mm]]
+		text,
+	};
+
+	struct SniffOptions
+	{
+		std::size_t sampleBytes = 64 << 10;
+		string_view_t candidates = ",;\t|"; // delimiters to choose from, in the order of preference; readers exist for these only
+		bool trustSample = false; // whether input without quotes in the sample may be read without quoting even if it continues beyond the sample
+	};
+
+	struct SniffResult
+	{
+		char_t delimiter = ',';
+		LineEnding lineEnding = LineEnding::lf;
+		bool header = false;
+		bool quotesSeen = false; // whether the sample contains quotes
+		bool quoting = true; // whether the reader has to handle quotes; false only if the sample is conclusive
+		bool complete = false; // whether the sample is all of the input
+		bool bom = false; // whether the input starts with a UTF-8 byte order mark, which the sniffed reader strips
+		std::size_t records = 0; // complete records in the sample, including the header
+		std::vector<CellType> types; // of every column
+		std::vector<string_t> names; // the header, if there is one
+	};
+
+	namespace Detail
+	{
+		// the records of a sample which starts at a record boundary, split at delimiter with doubled quotes. the cells keep
+		// their escapes, which doesn't matter for inferring types
+		[[nodiscard]] inline std::vector<std::vector<string_view_t>> splitSample(string_view_t sample, char_t delimiter)
+		{
+			std::vector<std::vector<string_view_t>> result;
+			std::size_t i = 0;
+			while(i < sample.size())
+			{
+				std::vector<string_view_t>& record = result.emplace_back();
+				for(;;)
+				{
+					std::size_t begin = i;
+					std::size_t end;
+					if(i < sample.size() && sample[i] == '"')
+					{
+						begin = ++i;
+						for(; i < sample.size(); ++i)
+						{
+							if(sample[i] != '"')
+								continue;
+							if(i + 1 == sample.size() || sample[i + 1] != '"')
+								break;
+							++i;
+						}
+						end = i;
+						while(i < sample.size() && sample[i] != delimiter && !isNewline(sample[i]))
+							++i;
+					}
+					else
+					{
+						while(i < sample.size() && sample[i] != delimiter && !isNewline(sample[i]))
+							++i;
+						end = i;
+					}
+					record.push_back(sample.substr(begin, end - begin));
+					if(i < sample.size() && sample[i] == delimiter)
+					{
+						++i;
+						continue;
+					}
+					i += i + 1 < sample.size() && sample[i] == '\r' && sample[i + 1] == '\n' ? 2 : 1;
+					break;
+				}
+			}
+			return result;
+		}
+
+		// the cell has to be followed by a character which can't continue a number, see convertCell
+		[[nodiscard]] inline std::optional<CellType> cellType(string_view_t cell) noexcept
+		{
+			if(cell.empty())
+				return std::nullopt;
+			std::int64_t integer;
+			if(convertCell(cell, integer))
+				return CellType::integer;
+			if(parseTimestamp(cell))
+				return CellType::timestamp;
+			double floating;
+			if(convertCell(cell, floating))
+				return CellType::floating;
+			return CellType::text;
+		}
+		[[nodiscard]] constexpr CellType unifyTypes(CellType lhs, CellType rhs) noexcept
+		{
+			if(lhs == rhs)
+				return lhs;
+			if((lhs == CellType::integer && rhs == CellType::floating) || (lhs == CellType::floating && rhs == CellType::integer))
+				return CellType::floating;
+			return CellType::text;
+		}
+	}
+
+	// infers the dialect, the header and the types of the columns from the start of some input. sample may be all of the
+	// input or a prefix of it
+	[[nodiscard]] inline SniffResult sniff(string_view_t sample, SniffOptions const& options = {})
+	{
+		SniffResult result;
+		result.complete = sample.size() <= options.sampleBytes;
+		sample = sample.substr(0, options.sampleBytes);
+		if(sample.substr(0, 3) == "\xEF\xBB\xBF")
+		{
+			sample.remove_prefix(3);
+			result.bom = true;
+		}
+
+		// an incomplete last record is dropped, and so is everything after an unterminated quote
+		bool inQuotes = false;
+		std::size_t end = 0;
+		bool lineEnding = false;
+		for(std::size_t i = 0; i < sample.size(); ++i)
+		{
+			const char_t c = sample[i];
+			if(c == '"')
+			{
+				inQuotes = !inQuotes;
+				result.quotesSeen = true;
+			}
+			else if(!inQuotes && isNewline(c))
+			{
+				if(c == '\r' && i + 1 == sample.size() && !result.complete)
+					break;
+				const bool crlf = c == '\r' && i + 1 < sample.size() && sample[i + 1] == '\n';
+				if(!lineEnding)
+				{
+					result.lineEnding = crlf ? LineEnding::crlf : c == '\r' ? LineEnding::cr : LineEnding::lf;
+					lineEnding = true;
+				}
+				i += crlf;
+				end = i + 1;
+			}
+		}
+		if(result.complete && !inQuotes)
+			end = sample.size();
+		// the copy terminates the last cell, as the numbers are converted like those of a Reader
+		const string_t terminated(sample.substr(0, end));
+		sample = terminated;
+		result.quoting = result.quotesSeen || !(result.complete || options.trustSample);
+
+		// the delimiter splits the most records into the same number of cells
+		std::vector<std::vector<string_view_t>> records;
+		double bestScore = -1;
+		for(const char_t candidate : options.candidates)
+		{
+			std::vector<std::vector<string_view_t>> split = Detail::splitSample(sample, candidate);
+			std::map<std::size_t, std::size_t> counts;
+			for(auto const& record : split)
+				++counts[record.size()];
+			std::size_t mode = 1;
+			std::size_t frequency = 0;
+			for(auto const& [cells, records] : counts)
+			{
+				if(records > frequency || (records == frequency && cells > mode))
+				{
+					mode = cells;
+					frequency = records;
+				}
+			}
+			const double score = mode > 1 ? static_cast<double>(frequency) / static_cast<double>(split.size()) + static_cast<double>(mode) * 1e-6 : 0;
+			if(score > bestScore)
+			{
+				bestScore = score;
+				result.delimiter = candidate;
+				records = std::move(split);
+			}
+		}
+		result.records = records.size();
+		if(records.empty())
+			return result;
+
+		const std::size_t columns = records[0].size();
+		const auto inferTypes = [&records, columns](std::size_t first)
+		{
+			std::vector<std::optional<CellType>> types(columns);
+			for(std::size_t i = first; i < records.size(); ++i)
+			{
+				for(std::size_t j = 0; j < columns && j < records[i].size(); ++j)
+				{
+					const std::optional<CellType> type = Detail::cellType(records[i][j]);
+					if(type)
+						types[j] = types[j] ? Detail::unifyTypes(*types[j], *type) : *type;
+				}
+			}
+			std::vector<CellType> result;
+			for(auto const& type : types)
+				result.push_back(type.value_or(CellType::text));
+			return result;
+		};
+
+		// a first record whose cells don't fit the types of the columns below is a header. if all columns are text, it is
+		// one if its cells are unique and don't reappear below
+		const std::vector<CellType> body = inferTypes(1);
+		if(records.size() > 1)
+		{
+			int votes = 0;
+			bool allText = true;
+			for(std::size_t j = 0; j < columns; ++j)
+			{
+				if(body[j] == CellType::text)
+					continue;
+				allText = false;
+				const std::optional<CellType> type = Detail::cellType(records[0][j]);
+				votes += type && Detail::unifyTypes(body[j], *type) == body[j] ? -1 : 1;
+			}
+			if(allText)
+			{
+				result.header = true;
+				for(std::size_t j = 0; j < columns && result.header; ++j)
+				{
+					const string_view_t name = records[0][j];
+					result.header = !name.empty();
+					for(std::size_t k = 0; k < j && result.header; ++k)
+						result.header = records[0][k] != name;
+					for(std::size_t i = 1; i < records.size() && result.header; ++i)
+						result.header = j >= records[i].size() || records[i][j] != name;
+				}
+			}
+			else
+				result.header = votes > 0;
+		}
+
+		result.types = result.header ? body : inferTypes(0);
+		if(result.header)
+			for(const string_view_t name : records[0])
+				result.names.emplace_back(name);
+		return result;
+	}
+	// samples the start of a file
+	[[nodiscard]] inline SniffResult sniffFile(std::filesystem::path const& path, SniffOptions const& options = {})
+	{
+		std::ifstream file(path, std::ifstream::binary);
+		if(!file)
+			throw std::runtime_error("uCSV::sniffFile: failed to open " + path.string());
+		// one more byte tells whether the sample is complete
+		string_t sample(options.sampleBytes + 1, '\0');
+		file.read(sample.data(), static_cast<std::streamsize>(sample.size()));
+		sample.resize(static_cast<std::size_t>(file.gcount()));
+		return sniff(sample, options);
+	}
+
+	namespace Detail
+	{
+		template<typename ErrorHandlerT, typename DelimiterMatcherT, typename DialectT, typename EncodingT, typename InputIteratorT, typename CallbackT>
+		decltype(auto) invokeSniffedEncoding(SniffResult const& sniffed, InputIteratorT begin, InputIteratorT end, ErrorHandlerT errorHandler, CallbackT& callback)
+		{
+			using ReaderType = Reader<InputIteratorT, ErrorHandlerT, DelimiterMatcherT, InputIteratorT, EncodingT, DialectT>;
+			if(sniffed.header)
+			{
+				ReaderType reader(std::move(begin), std::move(end), std::move(errorHandler), DelimiterMatcherT(), EncodingT(), DialectT(), uCSV::readHeader);
+				return callback(reader);
+			}
+			ReaderType reader(std::move(begin), std::move(end), std::move(errorHandler), DelimiterMatcherT(), EncodingT(), DialectT(), uCSV::ignoreHeader);
+			return callback(reader);
+		}
+		template<typename ErrorHandlerT, typename DelimiterMatcherT, typename DialectT, typename InputIteratorT, typename CallbackT>
+		decltype(auto) invokeSniffedDialect(SniffResult const& sniffed, InputIteratorT begin, InputIteratorT end, ErrorHandlerT errorHandler, CallbackT& callback)
+		{
+			// the byte order mark is stripped like sniff does, without validating the rest of the input
+			if(sniffed.bom)
+				return invokeSniffedEncoding<ErrorHandlerT, DelimiterMatcherT, DialectT, Utf8<Bom::strip, false>>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+			return invokeSniffedEncoding<ErrorHandlerT, DelimiterMatcherT, DialectT, RawEncoding>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+		}
+		template<typename ErrorHandlerT, typename DelimiterMatcherT, typename InputIteratorT, typename CallbackT>
+		decltype(auto) invokeSniffedReader(SniffResult const& sniffed, InputIteratorT begin, InputIteratorT end, ErrorHandlerT errorHandler, CallbackT& callback)
+		{
+			// without quotes, every character but the delimiter and newlines is part of a cell
+			if(sniffed.quoting)
+				return invokeSniffedDialect<ErrorHandlerT, DelimiterMatcherT, DefaultDialect>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+			return invokeSniffedDialect<ErrorHandlerT, DelimiterMatcherT, Dialect<'\0'>>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+		}
+	}
+
+	// constructs the reader that fits sniffed and calls callback(reader), which has to accept every kind of Reader, e.g.
+	// a generic lambda. the reader is specialized at compile time for the delimiter, for input without quotes and for
+	// input starting with a byte order mark. returns what callback returns, which has to be the same type for all of them.
+	// throws if the delimiter isn't one of the default candidates
+	template<typename ErrorHandlerT = ErrorIgnore, typename InputIteratorT, typename CallbackT>
+	decltype(auto) withSniffedReader(SniffResult const& sniffed, InputIteratorT begin, InputIteratorT end, CallbackT&& callback, ErrorHandlerT errorHandler = {})
+	{
+		switch(sniffed.delimiter)
+		{
+		case ',':
+			return Detail::invokeSniffedReader<ErrorHandlerT, Delimiter<','>>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+		case ';':
+			return Detail::invokeSniffedReader<ErrorHandlerT, Delimiter<';'>>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+		case '\t':
+			return Detail::invokeSniffedReader<ErrorHandlerT, Delimiter<'\t'>>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+		case '|':
+			return Detail::invokeSniffedReader<ErrorHandlerT, Delimiter<'|'>>(sniffed, std::move(begin), std::move(end), std::move(errorHandler), callback);
+		}
+		throw std::runtime_error("uCSV::withSniffedReader: unsupported delimiter");
+	}
+}
+
+#endif // !UCSV_SNIFF_HPP_INCLUDED
@@ -0,0 +1,470 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_SORT_HPP_INCLUDED
+#define UCSV_SORT_HPP_INCLUDED
+
+#include <uCSV.hpp>
+#include <uCSV/Pipeline.hpp>
+#include <uCSV/Spill.hpp>
+
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <queue>
+
+namespace uCSV
+{
+	struct SortKey
+	{
+		std::size_t column;
+		ColumnType type = ColumnType::string; // strings are compared bytewise
+		bool descending = false;
+	};
+	using SortKeys = std::vector<SortKey>;
+
+	struct SortOptions
+	{
+		std::size_t memory = std::size_t(256) << 20; // bytes held in memory at once across all threads: chunks of input and their keys
+		std::size_t threads = 0; // threads sorting runs; 0 picks one less than the number of hardware threads
+		std::size_t fanIn = 64; // runs merged at once, which bounds the number of open files
+		std::filesystem::path temporaryDirectory = {}; // empty picks the one of the system
+	};
+
+	struct SortStatistics
+	{
+		std::size_t rows = 0; // excluding the header
+		std::size_t runs = 0; // sorted runs written to temporary files
+		std::size_t mergePasses = 0; // intermediate merges needed because of fanIn
+	};
+
+	namespace Detail
+	{
+		struct SortValue
+		{
+			std::int64_t integer = 0;
+			double floating = 0;
+			std::size_t offset = 0; // of a string key in the strings of its chunk or run
+			std::size_t size = 0;
+			string_view_t string;
+			bool null = false;
+		};
+
+		// extracts and compares the keys of records
+		class SortKeyExtractor
+		{
+		public:
+			explicit SortKeyExtractor(SortKeys const& keys) noexcept
+				: mKeys(keys)
+			{
+			}
+
+			[[nodiscard]] std::size_t keys() const noexcept
+			{
+				return mKeys.size();
+			}
+			// the cells are copied into strings, since they only live until the next fetch. values.string is set by resolve
+			void extract(Deserializer const& row, SortValue* values, string_t& strings) const
+			{
+				for(std::size_t i = 0; i < mKeys.size(); ++i)
+				{
+					SortKey const& key = mKeys[i];
+					if(key.column >= row.total())
+						throw std::out_of_range("uCSV::externalSort: the key column doesn't exist");
+					const string_view_t cell = row.cell(key.column);
+					SortValue& value = values[i];
+					value = {};
+					switch(key.type)
+					{
+					case ColumnType::int64:
+						value.null = !convertCell(cell, value.integer);
+						break;
+					case ColumnType::float64:
+						value.null = !convertCell(cell, value.floating) || value.floating != value.floating;
+						break;
+					case ColumnType::string:
+						value.offset = strings.size();
+						value.size = cell.size();
+						strings.append(cell.data(), cell.size());
+						break;
+					}
+				}
+			}
+			void resolve(SortValue* values, std::size_t count, string_t const& strings) const noexcept
+			{
+				for(std::size_t i = 0; i < count; ++i)
+					values[i].string = string_view_t(strings.data() + values[i].offset, values[i].size);
+			}
+			// negative, zero or positive like strcmp. empty cells and cells which can't be converted to the type of their key
+			// are nulls, which come first, in descending order too
+			[[nodiscard]] int compare(SortValue const* lhs, SortValue const* rhs) const noexcept
+			{
+				for(std::size_t i = 0; i < mKeys.size(); ++i)
+				{
+					if(lhs[i].null != rhs[i].null)
+						return lhs[i].null ? -1 : 1;
+					int result = 0;
+					if(!lhs[i].null)
+					{
+						switch(mKeys[i].type)
+						{
+						case ColumnType::int64:
+							result = (lhs[i].integer > rhs[i].integer) - (lhs[i].integer < rhs[i].integer);
+							break;
+						case ColumnType::float64:
+							result = (lhs[i].floating > rhs[i].floating) - (lhs[i].floating < rhs[i].floating);
+							break;
+						case ColumnType::string:
+							result = lhs[i].string.compare(rhs[i].string);
+							break;
+						}
+					}
+					if(result != 0)
+						return mKeys[i].descending ? -result : result;
+				}
+				return 0;
+			}
+
+		private:
+			SortKeys const& mKeys;
+		};
+
+		// offset one past the end of the first (or the last) complete record in data, which starts at a record boundary.
+		// 0 if there is none. a \r at the end may be followed by a \n which hasn't been read yet
+		[[nodiscard]] inline std::size_t recordEnd(string_view_t data, bool last) noexcept
+		{
+			std::size_t result = 0;
+			bool inQuotes = false;
+			for(std::size_t i = 0; i < data.size(); ++i)
+			{
+				const char_t c = data[i];
+				if(c == '"')
+					inQuotes = !inQuotes;
+				else if(!inQuotes && isNewline(c))
+				{
+					if(c == '\r' && i + 1 == data.size())
+						break;
+					if(c == '\r' && data[i + 1] == '\n')
+						++i;
+					result = i + 1;
+					if(!last)
+						break;
+				}
+			}
+			return result;
+		}
+		struct SortChunkCut
+		{
+			std::size_t bytes = 0;
+			std::size_t records = 0;
+		};
+		// the longest prefix of complete records of data whose sort fits into budget. every record is charged its bytes,
+		// the copies of its string keys, which are at most as long, and overhead. the first record is taken regardless.
+		// if last, data ends the input and its final record needn't be terminated
+		[[nodiscard]] inline SortChunkCut sortChunkEnd(string_view_t data, std::size_t budget, std::size_t overhead, bool stringKeys, bool last) noexcept
+		{
+			SortChunkCut result;
+			std::size_t cost = 0;
+			while(result.bytes < data.size())
+			{
+				std::size_t length = recordEnd(data.substr(result.bytes), false);
+				if(length == 0 && !last)
+					break;
+				if(length == 0)
+					length = data.size() - result.bytes;
+				cost += length * (stringKeys ? 2 : 1) + overhead;
+				if(cost > budget && result.records > 0)
+					break;
+				result.bytes += length;
+				++result.records;
+			}
+			return result;
+		}
+		// the record without its terminator
+		[[nodiscard]] constexpr string_view_t trimRecord(string_view_t record) noexcept
+		{
+			while(!record.empty() && isNewline(record.back()))
+				record.remove_suffix(1);
+			return record;
+		}
+
+		inline void writeRunRecord(std::ofstream& file, string_view_t record)
+		{
+			const auto size = static_cast<std::uint64_t>(record.size());
+			file.write(reinterpret_cast<char const*>(&size), sizeof(size));
+			file.write(record.data(), static_cast<std::streamsize>(record.size()));
+		}
+
+		// the bytes sorting a record takes besides the record and its string keys, see sortChunk
+		[[nodiscard]] inline std::size_t sortRecordOverhead(std::size_t keys) noexcept
+		{
+			return sizeof(string_view_t) + sizeof(std::size_t) + keys * sizeof(SortValue);
+		}
+
+		// parses a chunk of complete records and passes their raw bytes to write in sorted order. returns the number of
+		// records. expected is the number of records the chunk is supposed to hold, which is reserved
+		template<typename DelimiterMatcherT, typename WriteT>
+		std::size_t sortChunk(string_t const& chunk, std::size_t expected, SortKeyExtractor const& extractor, DelimiterMatcherT const& delimiterMatcher, WriteT&& write)
+		{
+			using ReaderType = Reader<char_t const*, ErrorThrow<>, DelimiterMatcherT>;
+			ReaderType reader(chunk.data(), chunk.data() + chunk.size(), ErrorThrow<>(), delimiterMatcher, ignoreHeader);
+			const std::size_t keys = extractor.keys();
+			std::vector<string_view_t> records;
+			records.reserve(expected);
+			std::vector<SortValue> values;
+			values.reserve(expected * keys);
+			string_t strings;
+			while(!reader.done())
+			{
+				char_t const* const begin = reader.position();
+				std::optional<Deserializer> row = reader.fetch();
+				if(!row)
+					continue;
+				records.push_back(trimRecord(string_view_t(begin, static_cast<std::size_t>(reader.position() - begin))));
+				values.resize(values.size() + keys);
+				extractor.extract(*row, values.data() + values.size() - keys, strings);
+			}
+			extractor.resolve(values.data(), values.size(), strings);
+
+			std::vector<std::size_t> order(records.size());
+			for(std::size_t i = 0; i < order.size(); ++i)
+				order[i] = i;
+			std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs)
+			{
+				return extractor.compare(values.data() + lhs * keys, values.data() + rhs * keys) < 0;
+			});
+			for(const std::size_t index : order)
+				write(records[index]);
+			return records.size();
+		}
+
+		// reads the records of a run file one by one and parses their keys again
+		template<typename DelimiterMatcherT>
+		class SortRun
+		{
+		public:
+			SortRun(std::filesystem::path const& path, SortKeyExtractor const& extractor, DelimiterMatcherT const& delimiterMatcher)
+				: mFile(path, std::ifstream::binary), mExtractor(extractor), mDelimiterMatcher(delimiterMatcher), mValues(extractor.keys())
+			{
+				if(!mFile)
+					throw std::runtime_error("uCSV::externalSort: failed to open a temporary file");
+			}
+
+			[[nodiscard]] string_view_t record() const noexcept
+			{
+				return mRecord;
+			}
+			[[nodiscard]] SortValue const* values() const noexcept
+			{
+				return mValues.data();
+			}
+			// returns false at the end of the run
+			bool next()
+			{
+				std::uint64_t size;
+				if(!mFile.read(reinterpret_cast<char*>(&size), sizeof(size)))
+					return false;
+				mRecord.resize(static_cast<std::size_t>(size));
+				if(!mFile.read(mRecord.data(), static_cast<std::streamsize>(size)))
+					throw std::runtime_error("uCSV::externalSort: a temporary file is truncated");
+
+				char_t const* const begin = mRecord.data();
+				char_t const* const end = begin + mRecord.size();
+				if(!mReader)
+					mReader.emplace(begin, end, ErrorThrow<>(), mDelimiterMatcher, ignoreHeader);
+				else
+					mReader->reset(begin, end, ignoreHeader);
+				std::optional<Deserializer> row = mReader->fetch();
+				if(!row)
+					throw std::runtime_error("uCSV::externalSort: a temporary file is corrupt");
+				mStrings.clear();
+				mExtractor.extract(*row, mValues.data(), mStrings);
+				mExtractor.resolve(mValues.data(), mValues.size(), mStrings);
+				return true;
+			}
+
+		private:
+			std::ifstream mFile;
+			SortKeyExtractor const& mExtractor;
+			DelimiterMatcherT const& mDelimiterMatcher;
+			string_t mRecord;
+			std::vector<SortValue> mValues;
+			string_t mStrings;
+			std::optional<Reader<char_t const*, ErrorThrow<>, DelimiterMatcherT>> mReader;
+		};
+
+		// k-way merge of runs, which are in input order; equal keys keep that order
+		template<typename DelimiterMatcherT, typename WriteT>
+		void mergeRuns(std::vector<std::filesystem::path> const& paths, SortKeyExtractor const& extractor, DelimiterMatcherT const& delimiterMatcher, WriteT&& write)
+		{
+			std::vector<std::unique_ptr<SortRun<DelimiterMatcherT>>> runs;
+			runs.reserve(paths.size());
+			for(std::filesystem::path const& path : paths)
+				runs.push_back(std::make_unique<SortRun<DelimiterMatcherT>>(path, extractor, delimiterMatcher));
+
+			const auto after = [&runs, &extractor](std::size_t lhs, std::size_t rhs)
+			{
+				const int result = extractor.compare(runs[lhs]->values(), runs[rhs]->values());
+				return result > 0 || (result == 0 && lhs > rhs);
+			};
+			std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(after)> heap(after);
+			for(std::size_t i = 0; i < runs.size(); ++i)
+				if(runs[i]->next())
+					heap.push(i);
+			while(!heap.empty())
+			{
+				const std::size_t index = heap.top();
+				heap.pop();
+				write(runs[index]->record());
+				if(runs[index]->next())
+					heap.push(index);
+			}
+		}
+	}
+
+	// sorts CSV of any size by the keys, in bounded memory. the input is cut into chunks at record boundaries, which are
+	// parsed and sorted in parallel into runs on disk and finally merged. the records are copied byte for byte, i.e.
+	// their quoting is kept, but every record is terminated by \n in the output. the sort is stable. if doReadHeader, the
+	// first record is copied to the output as is. malformed records throw
+	template<typename DelimiterMatcherT = DefaultDelimiter, bool doReadHeader>
+	SortStatistics externalSort(std::istream& input, std::ostream& output, SortKeys const& keys, std::bool_constant<doReadHeader>, SortOptions options = {})
+	{
+		if(options.threads == 0)
+			options.threads = Detail::defaultThreads();
+		if(options.fanIn < 2)
+			options.fanIn = 2;
+		// every thread holds a chunk, and so does the reading one. a chunk is charged the memory its sort takes, too
+		const std::size_t chunkSize = std::max<std::size_t>(options.memory / (options.threads + 1), 1 << 16);
+		const std::size_t overhead = Detail::sortRecordOverhead(keys.size());
+		const bool stringKeys = std::any_of(keys.begin(), keys.end(), [](SortKey const& key)
+		{
+			return key.type == ColumnType::string;
+		});
+
+		SortStatistics result;
+		const DelimiterMatcherT delimiterMatcher{};
+		const Detail::SortKeyExtractor extractor(keys);
+		Detail::TemporaryFiles files(options.temporaryDirectory);
+		std::vector<std::filesystem::path> runs;
+		std::deque<std::future<std::size_t>> pending;
+		const auto writeOutput = [&output](string_view_t record)
+		{
+			output.write(record.data(), static_cast<std::streamsize>(record.size()));
+			output.put('\n');
+		};
+
+		string_t carry;
+		bool header = doReadHeader;
+		for(bool end = false; !end || !carry.empty();)
+		{
+			string_t chunk = std::move(carry);
+			carry = string_t();
+			// records longer than a chunk make it grow, whereas the records left over by the budget are sorted first
+			const std::size_t size = chunk.size();
+			const std::size_t grow = end ? 0 : size < chunkSize ? chunkSize - size : Detail::recordEnd(chunk, false) == 0 ? size : 0;
+			if(grow > 0)
+			{
+				chunk.resize(size + grow);
+				input.read(chunk.data() + size, static_cast<std::streamsize>(grow));
+				end = static_cast<std::size_t>(input.gcount()) < grow;
+				chunk.resize(size + static_cast<std::size_t>(input.gcount()));
+			}
+
+			if(header && !chunk.empty())
+			{
+				std::size_t length = Detail::recordEnd(chunk, false);
+				if(length == 0 && !end)
+				{
+					carry = std::move(chunk);
+					continue;
+				}
+				if(length == 0)
+					length = chunk.size();
+				writeOutput(Detail::trimRecord(string_view_t(chunk).substr(0, length)));
+				chunk.erase(0, length);
+				header = false;
+			}
+			const Detail::SortChunkCut cut = Detail::sortChunkEnd(chunk, chunkSize, overhead, stringKeys, end);
+			carry.assign(chunk, cut.bytes, string_t::npos);
+			chunk.resize(cut.bytes);
+			if(chunk.empty())
+				continue;
+
+			if(end && carry.empty() && runs.empty())
+			{
+				// everything fits into memory
+				result.rows += Detail::sortChunk(chunk, cut.records, extractor, delimiterMatcher, writeOutput);
+				break;
+			}
+
+			if(pending.size() >= options.threads)
+			{
+				result.rows += pending.front().get();
+				pending.pop_front();
+			}
+			runs.push_back(files.create());
+			pending.push_back(std::async(std::launch::async, [chunk = std::move(chunk), records = cut.records, path = runs.back(), &extractor, &delimiterMatcher]
+			{
+				std::ofstream file(path, std::ofstream::binary);
+				const std::size_t rows = Detail::sortChunk(chunk, records, extractor, delimiterMatcher, [&file](string_view_t record)
+				{
+					Detail::writeRunRecord(file, record);
+				});
+				if(!file.flush())
+					throw std::runtime_error("uCSV::externalSort: failed to write a temporary file");
+				return rows;
+			}));
+		}
+		for(; !pending.empty(); pending.pop_front())
+			result.rows += pending.front().get();
+		result.runs = runs.size();
+
+		while(runs.size() > options.fanIn)
+		{
+			// consecutive runs are merged, which keeps the sort stable
+			std::vector<std::filesystem::path> merged;
+			for(std::size_t first = 0; first < runs.size(); first += options.fanIn)
+			{
+				const std::vector<std::filesystem::path> group(runs.begin() + first, runs.begin() + std::min(first + options.fanIn, runs.size()));
+				merged.push_back(files.create());
+				std::ofstream file(merged.back(), std::ofstream::binary);
+				Detail::mergeRuns(group, extractor, delimiterMatcher, [&file](string_view_t record)
+				{
+					Detail::writeRunRecord(file, record);
+				});
+				if(!file.flush())
+					throw std::runtime_error("uCSV::externalSort: failed to write a temporary file");
+				for(std::filesystem::path const& path : group)
+					files.remove(path);
+			}
+			runs = std::move(merged);
+			++result.mergePasses;
+		}
+		if(!runs.empty())
+			Detail::mergeRuns(runs, extractor, delimiterMatcher, writeOutput);
+		if(!output)
+			throw std::runtime_error("uCSV::externalSort: failed to write the output");
+		return result;
+	}
+	template<typename DelimiterMatcherT = DefaultDelimiter, bool doReadHeader>
+	SortStatistics externalSort(std::filesystem::path const& input, std::filesystem::path const& output, SortKeys const& keys, std::bool_constant<doReadHeader> constant, SortOptions options = {})
+	{
+		std::ifstream in(input, std::ifstream::binary);
+		if(!in)
+			throw std::runtime_error("uCSV::externalSort: failed to open " + input.string());
+		std::ofstream out(output, std::ofstream::binary);
+		if(!out)
+			throw std::runtime_error("uCSV::externalSort: failed to open " + output.string());
+		const SortStatistics result = externalSort<DelimiterMatcherT>(in, out, keys, constant, std::move(options));
+		if(!out.flush())
+			throw std::runtime_error("uCSV::externalSort: failed to write " + output.string());
+		return result;
+	}
+}
+
+#endif // !UCSV_SORT_HPP_INCLUDED
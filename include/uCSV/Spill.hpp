@@ -0,0 +1,221 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_SPILL_HPP_INCLUDED
+#define UCSV_SPILL_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace uCSV
+{
+	// the temporary files and row formats shared by the algorithms that spill to disk, i.e. externalSort, hashJoin and diff
+	namespace Detail
+	{
+		// the temporary files of an algorithm, which are removed along with them
+		class TemporaryFiles
+		{
+		public:
+			explicit TemporaryFiles(std::filesystem::path directory)
+				: mDirectory(directory.empty() ? std::filesystem::temp_directory_path() : std::move(directory))
+			{
+				std::random_device random;
+				mPrefix = "ucsv-" + std::to_string(random()) + "-" + std::to_string(random()) + "-";
+			}
+			TemporaryFiles(TemporaryFiles const&) = delete;
+			TemporaryFiles& operator=(TemporaryFiles const&) = delete;
+			~TemporaryFiles()
+			{
+				for(std::filesystem::path const& path : mPaths)
+				{
+					std::error_code ec;
+					std::filesystem::remove(path, ec);
+				}
+			}
+
+			[[nodiscard]] std::filesystem::path create()
+			{
+				mPaths.push_back(mDirectory / (mPrefix + std::to_string(mPaths.size()) + ".tmp"));
+				return mPaths.back();
+			}
+			void remove(std::filesystem::path const& path) noexcept
+			{
+				std::error_code ec;
+				std::filesystem::remove(path, ec);
+			}
+
+		private:
+			std::filesystem::path mDirectory;
+			string_t mPrefix;
+			std::vector<std::filesystem::path> mPaths;
+		};
+
+		// rows copied out of a reader. every cell is terminated by '\0', so that they can be deserialized like the cells of
+		// a Reader. the views of the cells are only created by finish, since the bytes may reallocate while rows are added
+		class SpillRows
+		{
+		public:
+			[[nodiscard]] std::size_t size() const noexcept
+			{
+				return mRowEnds.size();
+			}
+			[[nodiscard]] std::size_t bytes() const noexcept
+			{
+				return mBytes.size() + mCellEnds.size() * (sizeof(std::size_t) + sizeof(string_view_t)) + mRowEnds.size() * sizeof(std::size_t);
+			}
+			void clear() noexcept
+			{
+				mBytes.clear();
+				mCellEnds.clear();
+				mRowEnds.clear();
+				mViews.clear();
+			}
+
+			void add(Deserializer const& row)
+			{
+				for(std::size_t i = 0; i < row.total(); ++i)
+				{
+					const string_view_t cell = row.cell(i);
+					mBytes.append(cell.data(), cell.size());
+					mCellEnds.push_back(mBytes.size());
+					mBytes.push_back('\0');
+				}
+				mRowEnds.push_back(mCellEnds.size());
+			}
+			// appends a row written by write; false at the end of the file
+			bool read(std::ifstream& file)
+			{
+				std::uint64_t cells;
+				if(!file.read(reinterpret_cast<char*>(&cells), sizeof(cells)))
+					return false;
+				for(std::uint64_t i = 0; i < cells && file; ++i)
+				{
+					std::uint64_t size = 0;
+					file.read(reinterpret_cast<char*>(&size), sizeof(size));
+					const std::size_t offset = mBytes.size();
+					mBytes.resize(offset + static_cast<std::size_t>(size) + 1);
+					file.read(mBytes.data() + offset, static_cast<std::streamsize>(size));
+					mCellEnds.push_back(offset + static_cast<std::size_t>(size));
+				}
+				if(!file)
+					throw std::runtime_error("uCSV: a temporary file is truncated");
+				mRowEnds.push_back(mCellEnds.size());
+				return true;
+			}
+			void write(std::ofstream& file, std::size_t row) const
+			{
+				const std::size_t first = firstCell(row);
+				const auto cells = static_cast<std::uint64_t>(mRowEnds[row] - first);
+				file.write(reinterpret_cast<char const*>(&cells), sizeof(cells));
+				for(std::size_t i = first; i < mRowEnds[row]; ++i)
+				{
+					const string_view_t value = cell(i);
+					const auto size = static_cast<std::uint64_t>(value.size());
+					file.write(reinterpret_cast<char const*>(&size), sizeof(size));
+					file.write(value.data(), static_cast<std::streamsize>(value.size()));
+				}
+			}
+
+			[[nodiscard]] string_view_t cell(std::size_t row, std::size_t column) const
+			{
+				const std::size_t first = firstCell(row);
+				if(column >= mRowEnds[row] - first)
+					throw std::out_of_range("uCSV: the key column doesn't exist");
+				return cell(first + column);
+			}
+			void finish()
+			{
+				mViews.resize(mCellEnds.size());
+				for(std::size_t i = 0; i < mViews.size(); ++i)
+					mViews[i] = cell(i);
+			}
+			// header may be nullptr, and is ignored if it has fewer names than the row has cells
+			[[nodiscard]] Deserializer row(std::size_t row, std::vector<string_t> const& header) const noexcept
+			{
+				const std::size_t first = firstCell(row);
+				const std::size_t cells = mRowEnds[row] - first;
+				return Deserializer(cells, header.size() >= cells ? header.data() : nullptr, mViews.data() + first);
+			}
+
+		private:
+			string_t mBytes;
+			std::vector<std::size_t> mCellEnds; // offsets of the terminators
+			std::vector<std::size_t> mRowEnds; // one past the index of the last cell of every row
+			std::vector<string_view_t> mViews;
+
+			[[nodiscard]] std::size_t firstCell(std::size_t row) const noexcept
+			{
+				return row == 0 ? 0 : mRowEnds[row - 1];
+			}
+			[[nodiscard]] string_view_t cell(std::size_t index) const noexcept
+			{
+				const std::size_t begin = index == 0 ? 0 : mCellEnds[index - 1] + 1;
+				return string_view_t(mBytes.data() + begin, mCellEnds[index] - begin);
+			}
+		};
+
+		// the output files of a partitioning pass, e.g. of hashJoin or diff
+		class SpillPartitions
+		{
+		public:
+			explicit SpillPartitions(std::vector<std::filesystem::path> const& paths)
+			{
+				mFiles.reserve(paths.size());
+				for(std::filesystem::path const& path : paths)
+				{
+					mFiles.emplace_back(path, std::ofstream::binary);
+					if(!mFiles.back())
+						throw std::runtime_error("uCSV: failed to open a temporary file");
+				}
+			}
+			[[nodiscard]] std::ofstream& operator[](std::size_t index) noexcept
+			{
+				return mFiles[index];
+			}
+			void flush()
+			{
+				for(std::ofstream& file : mFiles)
+					if(!file.flush())
+						throw std::runtime_error("uCSV: failed to write a temporary file");
+				mFiles.clear();
+			}
+
+		private:
+			std::vector<std::ofstream> mFiles;
+		};
+
+		// writes a row in the format read by SpillRows::read
+		inline void writeSpillRow(std::ofstream& file, Deserializer const& row)
+		{
+			const auto cells = static_cast<std::uint64_t>(row.total());
+			file.write(reinterpret_cast<char const*>(&cells), sizeof(cells));
+			for(std::size_t i = 0; i < row.total(); ++i)
+			{
+				const string_view_t cell = row.cell(i);
+				const auto size = static_cast<std::uint64_t>(cell.size());
+				file.write(reinterpret_cast<char const*>(&size), sizeof(size));
+				file.write(cell.data(), static_cast<std::streamsize>(cell.size()));
+			}
+		}
+
+		// the names of the header of reader; empty if it has none
+		template<typename ReaderT>
+		[[nodiscard]] std::vector<string_t> headerNames(ReaderT const& reader)
+		{
+			std::vector<string_t> header;
+			if(reader.hasHeader())
+				for(std::size_t i = 0; i < reader.columns(); ++i)
+					header.emplace_back(reader.header(i));
+			return header;
+		}
+	}
+}
+
+#endif // !UCSV_SPILL_HPP_INCLUDED
@@ -0,0 +1,366 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#ifndef UCSV_STATIC_HPP_INCLUDED
+#define UCSV_STATIC_HPP_INCLUDED
+
+#include <uCSV.hpp>
+
+#include <array>
+#include <limits>
+
+// parsing of CSV literals during compilation:
+//
+//	constexpr uCSV::string_view_t csv = "id,name\n1,alpha\n2,beta\n";
+//	constexpr auto table = uCSV::staticTable<std::pair<int, uCSV::string_view_t>, uCSV::staticRows(csv, uCSV::readHeader)>(csv, uCSV::readHeader);
+//
+// every function here may also be called at runtime, where errors are thrown as usual. during constant evaluation, the
+// throw expression turns a malformed table into a compile error
+namespace uCSV
+{
+	// the cells of one record of a literal. the cells are views into the literal, hence quoted cells containing escaped
+	// quotes ("") are rejected
+	class StaticRow
+	{
+	public:
+		using DelimiterFunction = bool (*)(char_t) noexcept;
+
+		constexpr StaticRow(string_view_t input, std::size_t position, DelimiterFunction delimiter) noexcept
+			: mInput(input), mPosition(position), mDelimiter(delimiter)
+		{
+		}
+
+		// whether there are more cells in this record
+		[[nodiscard]] constexpr bool remaining() const noexcept
+		{
+			return mContinues;
+		}
+		// number of cells read thus far
+		[[nodiscard]] constexpr std::size_t index() const noexcept
+		{
+			return mIndex;
+		}
+		// the position in the input after the last cell read, which is the start of the next record once remaining() is false
+		[[nodiscard]] constexpr std::size_t position() const noexcept
+		{
+			return mPosition;
+		}
+
+		constexpr string_view_t next()
+		{
+			if(!mContinues)
+				throw std::out_of_range("uCSV::StaticRow: the record has no more cells");
+			const std::size_t size = mInput.size();
+			std::size_t begin = mPosition;
+			std::size_t end = begin;
+			if(mPosition < size && mInput[mPosition] == '"')
+			{
+				begin = ++mPosition;
+				for(;; ++mPosition)
+				{
+					if(mPosition == size)
+						throw std::runtime_error("uCSV::StaticRow: unexpected end of input within a quoted cell");
+					if(mInput[mPosition] == '"')
+					{
+						if(mPosition + 1 < size && mInput[mPosition + 1] == '"')
+							throw std::runtime_error("uCSV::StaticRow: escaped quotes aren't supported in literals");
+						break;
+					}
+				}
+				end = mPosition++;
+				if(mPosition < size && !mDelimiter(mInput[mPosition]) && !isNewline(mInput[mPosition]))
+					throw std::runtime_error("uCSV::StaticRow: bad cell");
+			}
+			else
+			{
+				for(; mPosition < size && !mDelimiter(mInput[mPosition]) && !isNewline(mInput[mPosition]); ++mPosition)
+					if(mInput[mPosition] == '"')
+						throw std::runtime_error("uCSV::StaticRow: bad cell");
+				end = mPosition;
+			}
+
+			if(mPosition < size && mDelimiter(mInput[mPosition]))
+				++mPosition; // a delimiter at the very end of the input is followed by an empty cell
+			else
+			{
+				mContinues = false;
+				if(mPosition < size)
+					mPosition += mInput[mPosition] == '\r' && mPosition + 1 < size && mInput[mPosition + 1] == '\n' ? 2 : 1;
+			}
+			++mIndex;
+			return mInput.substr(begin, end - begin);
+		}
+
+	private:
+		string_view_t mInput;
+		std::size_t mPosition;
+		DelimiterFunction mDelimiter;
+		std::size_t mIndex = 0;
+		bool mContinues = true;
+	};
+
+	namespace Detail
+	{
+		template<typename DelimiterMatcherT>
+		[[nodiscard]] constexpr bool staticDelimiter(char_t c) noexcept
+		{
+			return DelimiterMatcherT()(c);
+		}
+
+		// calls f with every record, returns the number of records
+		template<typename DelimiterMatcherT, typename FunctionT>
+		constexpr std::size_t staticRecords(string_view_t csv, FunctionT&& f)
+		{
+			std::size_t records = 0;
+			std::size_t columns = 0;
+			for(std::size_t position = 0; position < csv.size(); ++records)
+			{
+				if(isNewline(csv[position]))
+					throw std::runtime_error("uCSV::staticTable: empty record");
+				StaticRow row(csv, position, &staticDelimiter<DelimiterMatcherT>);
+				f(row, records);
+				while(row.remaining())
+					row.next();
+				if(records == 0)
+					columns = row.index();
+				else if(row.index() != columns)
+					throw std::runtime_error("uCSV::staticTable: incorrect number of columns");
+				position = row.position();
+			}
+			return records;
+		}
+
+		template<typename T>
+		constexpr void staticInteger(string_view_t cell, T& target)
+		{
+			const bool negative = std::is_signed_v<T> && !cell.empty() && cell[0] == '-';
+			if(negative)
+				cell.remove_prefix(1);
+			if(cell.empty())
+				throw std::runtime_error("uCSV::deserialize: failed to convert string to integer");
+			// accumulated in the direction of the sign, since the negative range is larger
+			T result = 0;
+			for(const char_t c : cell)
+			{
+				if(c < '0' || c > '9')
+					throw std::runtime_error("uCSV::deserialize: failed to convert string to integer");
+				const T digit = static_cast<T>(c - '0');
+				if(negative ? result < (std::numeric_limits<T>::min() + digit) / 10 : result > (std::numeric_limits<T>::max() - digit) / 10)
+					throw std::out_of_range("uCSV::deserialize: integer out of range");
+				result = static_cast<T>(result * 10 + (negative ? -digit : digit));
+			}
+			target = result;
+		}
+
+		// the normalized significand m, i.e. with its top bit set, times 10 or divided by 10 and rounded to 64 bits. the
+		// binary exponent e grows accordingly
+		constexpr void staticScale10(std::uint64_t& m, int& e, bool up) noexcept
+		{
+			constexpr std::uint64_t low = 0xFFFFFFFFu;
+			std::uint64_t result = 0;
+			bool carry = false;
+			if(up)
+			{
+				// m * 10 has 67 or 68 bits, of which the top 64 are kept
+				const std::uint64_t lower = (m & low) * 10;
+				const std::uint64_t upper = (m >> 32) * 10 + (lower >> 32);
+				const int shift = upper >> 35 ? 4 : 3;
+				result = upper << (32 - shift) | (lower & low) >> shift;
+				carry = (lower >> (shift - 1)) & 1;
+				e += shift;
+			}
+			else
+			{
+				// (m << shift) / 10 has 64 bits
+				const int shift = m < 0xA000000000000000u ? 4 : 3;
+				std::uint64_t remainder = m >> (64 - shift);
+				const std::uint64_t shifted = m << shift;
+				const std::uint64_t a = remainder << 32 | shifted >> 32;
+				remainder = a % 10;
+				const std::uint64_t b = remainder << 32 | (shifted & low);
+				result = (a / 10) << 32 | b / 10;
+				carry = b % 10 >= 5;
+				e -= shift;
+			}
+			m = result + carry;
+			if(m == 0)
+			{
+				m = std::uint64_t(1) << 63;
+				++e;
+			}
+		}
+
+		// decimal and scientific notation. the significand is rounded to 19 digits and scaled with 64 bits of precision
+		// regardless of the width of long double, so the result may differ from strtod in the last bit
+		template<typename T>
+		constexpr void staticFloating(string_view_t cell, T& target)
+		{
+			std::size_t i = 0;
+			const bool negative = i < cell.size() && cell[i] == '-';
+			if(negative || (i < cell.size() && cell[i] == '+'))
+				++i;
+			std::uint64_t significand = 0;
+			int exponent = 0;
+			std::size_t digits = 0;
+			const auto digit = [&cell](std::size_t at) constexpr noexcept { return at < cell.size() && cell[at] >= '0' && cell[at] <= '9'; };
+			for(; digit(i); ++i, ++digits)
+			{
+				if(significand < 1000000000000000000u)
+					significand = significand * 10 + static_cast<std::uint64_t>(cell[i] - '0');
+				else
+					++exponent;
+			}
+			if(i < cell.size() && cell[i] == '.')
+			{
+				for(++i; digit(i); ++i, ++digits)
+				{
+					if(significand < 1000000000000000000u)
+					{
+						significand = significand * 10 + static_cast<std::uint64_t>(cell[i] - '0');
+						--exponent;
+					}
+				}
+			}
+			if(digits == 0)
+				throw std::runtime_error("uCSV::deserialize: failed to convert string to floating point number");
+			if(i < cell.size() && (cell[i] == 'e' || cell[i] == 'E'))
+			{
+				++i;
+				const bool negativeExponent = i < cell.size() && cell[i] == '-';
+				if(negativeExponent || (i < cell.size() && cell[i] == '+'))
+					++i;
+				if(!digit(i))
+					throw std::runtime_error("uCSV::deserialize: failed to convert string to floating point number");
+				int explicitExponent = 0;
+				for(; digit(i); ++i)
+					if(explicitExponent < 100000)
+						explicitExponent = explicitExponent * 10 + (cell[i] - '0');
+				exponent += negativeExponent ? -explicitExponent : explicitExponent;
+			}
+			if(i != cell.size())
+				throw std::runtime_error("uCSV::deserialize: failed to convert string to floating point number");
+
+			// significand * 10^exponent == m * 2^e, which is only rounded to T at the end. beyond the range of long double the
+			// result is zero or infinite anyway
+			std::uint64_t m = significand;
+			int e = 0;
+			for(; m != 0 && !(m >> 63); m <<= 1)
+				--e;
+			constexpr int range = std::numeric_limits<long double>::max_exponent - std::numeric_limits<long double>::min_exponent + 128;
+			for(; m != 0 && exponent != 0 && e < range && e > -range; exponent += exponent < 0 ? 1 : -1)
+				staticScale10(m, e, exponent > 0);
+			T result = static_cast<T>(m);
+			for(; e > 0 && result != 0 && result <= std::numeric_limits<T>::max(); --e)
+				result *= 2;
+			// halving is exact while the result is normal, the rest is divided at once so that a subnormal one is rounded once
+			for(; e < 0 && result / 2 >= std::numeric_limits<T>::min(); ++e)
+				result /= 2;
+			T power = 1;
+			for(; e < 0 && power <= std::numeric_limits<T>::max(); ++e)
+				power *= 2;
+			result /= power;
+			target = negative ? -result : result;
+		}
+
+		template<typename T>
+		inline constexpr bool isStaticInteger = std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char_t>;
+	}
+
+	constexpr void deserialize(StaticRow& data, string_view_t& target)
+	{
+		target = data.next();
+	}
+	template<typename T>
+	constexpr std::enable_if_t<Detail::isStaticInteger<T>> deserialize(StaticRow& data, T& target)
+	{
+		Detail::staticInteger(data.next(), target);
+	}
+	template<typename T>
+	constexpr std::enable_if_t<std::is_floating_point_v<T>> deserialize(StaticRow& data, T& target)
+	{
+		Detail::staticFloating(data.next(), target);
+	}
+	template<typename T, std::size_t size>
+	constexpr void deserialize(StaticRow& data, std::array<T, size>& target)
+	{
+		for(T& element : target)
+			deserialize(data, element);
+	}
+	template<typename T, typename U>
+	constexpr void deserialize(StaticRow& data, std::pair<T, U>& target)
+	{
+		deserialize(data, target.first);
+		deserialize(data, target.second);
+	}
+	namespace Detail
+	{
+		template<typename... Types, std::size_t... indices>
+		constexpr void deserializeTupleHelper(StaticRow& data, std::tuple<Types...>& target, std::index_sequence<indices...>)
+		{
+			static_assert(sizeof...(Types) == sizeof...(indices));
+			(deserialize(data, std::get<indices>(target)), ...);
+		}
+	}
+	template<typename... Types>
+	constexpr void deserialize(StaticRow& data, std::tuple<Types...>& target)
+	{
+		Detail::deserializeTupleHelper(data, target, std::index_sequence_for<Types...>());
+	}
+
+	// number of records in csv, excluding the header if doReadHeader
+	template<typename DelimiterMatcherT = DefaultDelimiter, bool doReadHeader>
+	[[nodiscard]] constexpr std::size_t staticRows(string_view_t csv, std::bool_constant<doReadHeader>)
+	{
+		const std::size_t records = Detail::staticRecords<DelimiterMatcherT>(csv, [](StaticRow&, std::size_t) constexpr noexcept {});
+		if(doReadHeader && records == 0)
+			throw std::runtime_error("uCSV::staticRows: missing header");
+		return doReadHeader ? records - 1 : records;
+	}
+	// number of cells in the first record
+	template<typename DelimiterMatcherT = DefaultDelimiter>
+	[[nodiscard]] constexpr std::size_t staticColumns(string_view_t csv)
+	{
+		StaticRow row(csv, 0, &Detail::staticDelimiter<DelimiterMatcherT>);
+		while(!csv.empty() && row.remaining())
+			row.next();
+		return row.index();
+	}
+
+	template<std::size_t columns, typename DelimiterMatcherT = DefaultDelimiter>
+	[[nodiscard]] constexpr std::array<string_view_t, columns> staticHeader(string_view_t csv)
+	{
+		if(staticColumns<DelimiterMatcherT>(csv) != columns)
+			throw std::runtime_error("uCSV::staticHeader: incorrect number of columns");
+		std::array<string_view_t, columns> result{};
+		StaticRow row(csv, 0, &Detail::staticDelimiter<DelimiterMatcherT>);
+		deserialize(row, result);
+		return result;
+	}
+
+	// parses csv into rows instances of RowT. every row has to consume all cells of its record
+	template<typename RowT, std::size_t rows, typename DelimiterMatcherT = DefaultDelimiter, bool doReadHeader>
+	[[nodiscard]] constexpr std::array<RowT, rows> staticTable(string_view_t csv, std::bool_constant<doReadHeader>)
+	{
+		std::array<RowT, rows> result{};
+		const std::size_t records = Detail::staticRecords<DelimiterMatcherT>(csv, [&result](StaticRow& row, std::size_t record) constexpr
+		{
+			if(doReadHeader && record == 0)
+				return;
+			const std::size_t index = doReadHeader ? record - 1 : record;
+			if(index >= rows)
+				throw std::length_error("uCSV::staticTable: more records than rows");
+			deserialize(row, result[index]);
+			if(row.remaining())
+				throw std::runtime_error("uCSV::staticTable: the row type doesn't consume all cells of a record");
+		});
+		if(records != (doReadHeader ? rows + 1 : rows))
+			throw std::length_error("uCSV::staticTable: fewer records than rows");
+		return result;
+	}
+}
+
+#endif // !UCSV_STATIC_HPP_INCLUDED
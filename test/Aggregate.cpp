@@ -0,0 +1,109 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Aggregate.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+
+TEST_CASE("aggregate", "[uCSV][Aggregate]")
+{
+	constexpr int n = 30000;
+	string_t data = "group,value,other\n";
+	struct Expected
+	{
+		std::size_t rows = 0;
+		std::size_t count = 0;
+		double sum = 0;
+		double min = 1e300;
+		double max = -1e300;
+	};
+	std::map<string_t, Expected> expected;
+	for(int i = 0; i < n; ++i)
+	{
+		const string_t group = i % 7 == 0 ? "g,\"" + std::to_string(i % 5) + "\"" : "g" + std::to_string(i % 97);
+		const bool number = i % 11 != 0;
+		const double value = (i % 1000) * 0.25 - 100;
+		data += escapeToStr(group) + ',' + (number ? std::to_string(value) : string_t(i % 2 ? "x" : "")) + ",1\n";
+		Expected& target = expected[group];
+		++target.rows;
+		if(number)
+		{
+			++target.count;
+			target.sum += value;
+			target.min = std::min(target.min, value);
+			target.max = std::max(target.max, value);
+		}
+	}
+
+	const Aggregates aggregates = {
+		{ Aggregation::count, 1 },
+		{ Aggregation::sum, 1 },
+		{ Aggregation::min, 1 },
+		{ Aggregation::max, 1 },
+		{ Aggregation::mean, 1 },
+		{ Aggregation::sum, 2 },
+	};
+	for(const std::size_t threads : { 1, 4 })
+	{
+		std::istringstream stream(data);
+		Reader reader(stream, ErrorThrow{}, readHeader);
+		AggregateOptions options;
+		options.threads = threads;
+		options.batchRows = 100;
+		const AggregateResult result = aggregate(reader, 0, aggregates, options);
+		CHECK(result.rows == n);
+		CHECK(result.invalidCells == (n + 10) / 11); // the cells of column 1 are converted once for all of its aggregates
+		REQUIRE(result.groups.size() == expected.size());
+		auto it = expected.begin();
+		for(AggregateGroup const& group : result.groups)
+		{
+			Expected const& target = (it++)->second;
+			REQUIRE(group.values.size() == aggregates.size());
+			CHECK(group.rows == target.rows);
+			CHECK(group.values[0] == target.count);
+			CHECK(group.values[1] == Approx(target.sum));
+			CHECK(group.values[2] == target.min);
+			CHECK(group.values[3] == target.max);
+			CHECK(group.values[4] == Approx(target.sum / target.count));
+			CHECK(group.values[5] == target.rows);
+		}
+	}
+}
+
+TEST_CASE("aggregate edge cases", "[uCSV][Aggregate]")
+{
+	const string_view_t data = "a,x\nb,1\na,\nb,1.5abc\n";
+	Reader reader(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+	AggregateOptions options;
+	options.threads = 2;
+	const AggregateResult result = aggregate(reader, 0, { { Aggregation::min, 1 }, { Aggregation::sum, 1 } }, options);
+	REQUIRE(result.groups.size() == 2);
+	CHECK(result.groups[0].key == "a");
+	CHECK(result.groups[0].rows == 2);
+	CHECK(std::isnan(result.groups[0].values[0]));
+	CHECK(result.groups[0].values[1] == 0);
+	CHECK(result.groups[1].values[0] == 1);
+	// a partially numeric cell is invalid as a whole
+	CHECK(result.groups[1].values[1] == 1);
+	CHECK(result.invalidCells == 3);
+
+	Reader counting(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+	CHECK(aggregate(counting, 1, {}, options).groups.size() == 4);
+
+	for(const std::size_t threads : { 1, 2 })
+	{
+		Reader missing(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+		options.threads = threads;
+		CHECK_THROWS_AS(aggregate(missing, 2, {}, options), std::out_of_range);
+	}
+}
@@ -0,0 +1,298 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace
+{
+	// counts every allocation of the test binary
+	std::atomic<std::size_t> globalAllocations{ 0 };
+
+	template<typename T>
+	struct CountingAllocator
+	{
+		using value_type = T;
+
+		std::size_t* allocations;
+
+		explicit CountingAllocator(std::size_t* counter) noexcept
+			: allocations(counter)
+		{
+		}
+		template<typename U>
+		CountingAllocator(CountingAllocator<U> const& other) noexcept
+			: allocations(other.allocations)
+		{
+		}
+
+		[[nodiscard]] T* allocate(std::size_t n)
+		{
+			++*allocations;
+			return std::allocator<T>().allocate(n);
+		}
+		void deallocate(T* p, std::size_t n) noexcept
+		{
+			std::allocator<T>().deallocate(p, n);
+		}
+
+		template<typename U>
+		[[nodiscard]] friend bool operator==(CountingAllocator const& lhs, CountingAllocator<U> const& rhs) noexcept
+		{
+			return lhs.allocations == rhs.allocations;
+		}
+		template<typename U>
+		[[nodiscard]] friend bool operator!=(CountingAllocator const& lhs, CountingAllocator<U> const& rhs) noexcept
+		{
+			return lhs.allocations != rhs.allocations;
+		}
+	};
+
+	class CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		std::size_t allocations = 0;
+
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			++allocations;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+		{
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	string_t generate(std::size_t rows)
+	{
+		string_t result = "id,name,value\n";
+		for(std::size_t i = 0; i < rows; ++i)
+		{
+			result += std::to_string(i % 1000);
+			result += i % 3 == 0 ? ",\"a quoted, rather long name which doesn't fit into any small string buffer\"," : ",short,";
+			result += std::to_string(i % 7);
+			result += '\n';
+		}
+		return result;
+	}
+}
+
+// every form is replaced, as the library's forms mustn't release memory allocated by these and vice versa. this replaces
+// them for the whole binary, hence these tests are built as an executable of their own
+namespace
+{
+	void* countedAllocate(std::size_t size, std::size_t alignment = 0) noexcept
+	{
+		++globalAllocations;
+		size = size ? size : 1;
+		if(alignment <= alignof(std::max_align_t))
+			return std::malloc(size);
+#ifdef _MSC_VER
+		return _aligned_malloc(size, alignment);
+#else
+		return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+	}
+	void* countedAllocateOrThrow(std::size_t size, std::size_t alignment = 0)
+	{
+		if(void* p = countedAllocate(size, alignment))
+			return p;
+		throw std::bad_alloc();
+	}
+	// memory of _aligned_malloc has to be released by _aligned_free
+	void countedFree(void* p, std::align_val_t alignment) noexcept
+	{
+#ifdef _MSC_VER
+		if(static_cast<std::size_t>(alignment) > alignof(std::max_align_t))
+		{
+			_aligned_free(p);
+			return;
+		}
+#else
+		static_cast<void>(alignment);
+#endif
+		std::free(p);
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	return countedAllocateOrThrow(size);
+}
+void* operator new[](std::size_t size)
+{
+	return countedAllocateOrThrow(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+	return countedAllocate(size);
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+	return countedAllocate(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept
+{
+	return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept
+{
+	return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::align_val_t alignment) noexcept
+{
+	countedFree(p, alignment);
+}
+void operator delete[](void* p, std::align_val_t alignment) noexcept
+{
+	countedFree(p, alignment);
+}
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+	countedFree(p, alignment);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+	countedFree(p, alignment);
+}
+void operator delete(void* p, std::nothrow_t const&) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, std::nothrow_t const&) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::align_val_t alignment, std::nothrow_t const&) noexcept
+{
+	countedFree(p, alignment);
+}
+void operator delete[](void* p, std::align_val_t alignment, std::nothrow_t const&) noexcept
+{
+	countedFree(p, alignment);
+}
+
+TEST_CASE("zero allocations", "[uCSV][Allocation]")
+{
+	constexpr std::size_t rows = 1000000;
+	const string_t data = generate(rows);
+
+	SECTION("allocator")
+	{
+		std::size_t allocations = 0;
+		const CountingAllocator<char_t> allocator(&allocations);
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, DefaultDelimiter{}, RawEncoding{}, DefaultDialect{}, allocator, readHeader);
+		static_assert(std::is_same_v<decltype(reader)::AllocatorType, CountingAllocator<char_t>>);
+
+		std::tuple<int, string_t, int> row;
+		std::get<1>(row).reserve(128);
+		std::size_t fetched = 0;
+		const std::size_t warmup = 10;
+		for(; fetched < warmup && reader.fetch(row); ++fetched);
+		const std::size_t warm = allocations;
+		const std::size_t global = globalAllocations;
+		for(; !reader.done() && reader.fetch(row); ++fetched);
+		CHECK(fetched == rows);
+		CHECK(allocations == warm);
+		CHECK(globalAllocations == global);
+	}
+	SECTION("polymorphic allocator")
+	{
+		CountingResource resource;
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, DefaultDelimiter{}, RawEncoding{}, DefaultDialect{}, std::pmr::polymorphic_allocator<char_t>(&resource), readHeader);
+		CHECK(reader.allocator().resource() == &resource);
+
+		std::vector<string_t> row;
+		std::size_t fetched = 0;
+		for(; fetched < 10 && reader.fetch(row); ++fetched)
+			for(string_t& cell : row)
+				cell.reserve(128);
+		const std::size_t warm = resource.allocations;
+		const std::size_t global = globalAllocations;
+		for(; !reader.done() && reader.fetch(row); ++fetched);
+		CHECK(fetched == rows);
+		CHECK(resource.allocations == warm);
+		CHECK(resource.allocations > 0);
+		CHECK(globalAllocations == global);
+	}
+}
+
+TEST_CASE("arena", "[uCSV][Allocation]")
+{
+	constexpr std::size_t rows = 100000;
+	const string_t data = generate(rows);
+
+	CountingResource upstream;
+	std::pmr::monotonic_buffer_resource arena(&upstream);
+	{
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, readHeader);
+		std::pmr::vector<std::pmr::vector<std::pmr::string>> table(&arena);
+		const std::size_t global = globalAllocations;
+		CHECK(reader.emplaceAll(table) == rows);
+		// the reader allocates its buffers, the cells don't allocate anything but the chunks of the arena
+		CHECK(globalAllocations - global < 100 + upstream.allocations);
+		CHECK(upstream.allocations < 100);
+		REQUIRE(table.size() == rows);
+		CHECK(table[3][1] == "a quoted, rather long name which doesn't fit into any small string buffer");
+		CHECK(table[3][1].get_allocator().resource() == &arena);
+		CHECK(table[4][2] == "4");
+	}
+	{
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, readHeader);
+		std::pmr::vector<std::tuple<int, std::pmr::string, int>> table(&arena);
+		const std::size_t allocations = upstream.allocations;
+		const std::size_t global = globalAllocations;
+		CHECK(reader.emplaceAll(table) == rows);
+		CHECK(globalAllocations - global < 100 + upstream.allocations - allocations);
+		CHECK(std::get<1>(table[rows - 1]).get_allocator().resource() == &arena);
+		CHECK(std::get<0>(table[999]) == 999);
+	}
+}
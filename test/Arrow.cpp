@@ -0,0 +1,122 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Arrow.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <limits>
+#include <string>
+
+TEST_CASE("arrow", "[uCSV][Arrow]")
+{
+	const string_view_t data = "id,name,weight\n1,alpha,0.5\n2,,x\n,\"ga,mma\",2\n4,delta,\n5,epsilon,5\n";
+	Reader reader(data.begin(), data.end(), ErrorFlags{}, readHeader);
+	const ArrowColumns columns =
+	{
+		{ 0, ColumnType::int64 },
+		{ 1, ColumnType::string, "label" },
+		{ 2, ColumnType::float64, {}, false },
+	};
+
+	ArrowSchema schema;
+	exportArrowSchema(reader, columns, schema);
+	CHECK(std::strcmp(schema.format, "+s") == 0);
+	REQUIRE(schema.n_children == 3);
+	CHECK(std::strcmp(schema.children[0]->name, "id") == 0);
+	CHECK(std::strcmp(schema.children[1]->name, "label") == 0);
+	CHECK(std::strcmp(schema.children[1]->format, "U") == 0);
+	CHECK(std::strcmp(schema.children[2]->format, "g") == 0);
+	CHECK(schema.children[2]->flags == 0);
+	CHECK(schema.children[0]->flags == ARROW_FLAG_NULLABLE);
+	schema.release(&schema);
+	CHECK(schema.release == nullptr);
+
+	ArrowArray batch;
+	REQUIRE(fetchArrow(reader, columns, 4, batch) == 4);
+	CHECK(reader.errorHandler().badCell());
+	CHECK(batch.length == 4);
+	REQUIRE(batch.n_children == 3);
+
+	ArrowArray const& ids = *batch.children[0];
+	CHECK(ids.length == 4);
+	CHECK(ids.null_count == 1);
+	auto const* idValidity = static_cast<std::uint8_t const*>(ids.buffers[0]);
+	CHECK(idValidity[0] == 0b1011);
+	auto const* idValues = static_cast<std::int64_t const*>(ids.buffers[1]);
+	CHECK(idValues[0] == 1);
+	CHECK(idValues[3] == 4);
+
+	ArrowArray const& names = *batch.children[1];
+	CHECK(names.n_buffers == 3);
+	CHECK(names.null_count == 1);
+	auto const* offsets = static_cast<std::int64_t const*>(names.buffers[1]);
+	auto const* bytes = static_cast<char const*>(names.buffers[2]);
+	CHECK(string_view_t(bytes + offsets[2], static_cast<std::size_t>(offsets[3] - offsets[2])) == "ga,mma");
+	CHECK(offsets[1] == offsets[2]);
+
+	ArrowArray const& weights = *batch.children[2];
+	CHECK(weights.null_count == 0);
+	CHECK(weights.buffers[0] == nullptr);
+	auto const* weightValues = static_cast<double const*>(weights.buffers[1]);
+	CHECK(weightValues[0] == 0.5);
+	CHECK(weightValues[1] == 0);
+	CHECK(weightValues[2] == 2);
+
+	// a consumer may move a child out before releasing the parent
+	ArrowArray moved = *batch.children[1];
+	batch.children[1]->release = nullptr;
+	batch.release(&batch);
+	CHECK(batch.release == nullptr);
+	moved.release(&moved);
+
+	REQUIRE(fetchArrow(reader, columns, 4, batch) == 1);
+	CHECK(static_cast<std::int64_t const*>(batch.children[0]->buffers[1])[0] == 5);
+	batch.release(&batch);
+	CHECK(fetchArrow(reader, columns, 4, batch) == 0);
+	CHECK(batch.length == 0);
+	batch.release(&batch);
+}
+
+TEST_CASE("arrow unlimited batch", "[uCSV][Arrow]")
+{
+	string_t data;
+	for(int i = 0; i < 100000; ++i)
+		data += std::to_string(i) + '\n';
+	Reader reader(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+	ArrowArray batch;
+	REQUIRE(fetchArrow(reader, { { 0, ColumnType::int64, {}, false } }, std::numeric_limits<std::size_t>::max(), batch) == 100000);
+	CHECK(static_cast<std::int64_t const*>(batch.children[0]->buffers[1])[99999] == 99999);
+	batch.release(&batch);
+}
+
+TEST_CASE("arrow partially numeric cells", "[uCSV][Arrow]")
+{
+	const string_view_t data = "12abc,1.5abc\n";
+	Reader reader(data.begin(), data.end(), ErrorFlags{}, ignoreHeader);
+	const ArrowColumns columns =
+	{
+		{ 0, ColumnType::int64, {}, false },
+		{ 1, ColumnType::float64, {}, false },
+	};
+
+	ArrowArray batch;
+	REQUIRE(fetchArrow(reader, columns, 1, batch) == 1);
+	CHECK(reader.errorHandler().badCell());
+	CHECK(static_cast<std::int64_t const*>(batch.children[0]->buffers[1])[0] == 0);
+	CHECK(static_cast<double const*>(batch.children[1]->buffers[1])[0] == 0);
+	batch.release(&batch);
+
+	// nullable columns turn them into nulls
+	Reader nullable(data.begin(), data.end(), ErrorFlags{}, ignoreHeader);
+	REQUIRE(fetchArrow(nullable, { { 0, ColumnType::int64 }, { 1, ColumnType::float64 } }, 1, batch) == 1);
+	CHECK(batch.children[0]->null_count == 1);
+	CHECK(batch.children[1]->null_count == 1);
+	batch.release(&batch);
+}
@@ -0,0 +1,81 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <Check.hpp>
+using namespace uCSV;
+using namespace uCSV::Check;
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	Options smallChunks()
+	{
+		Options options;
+		options.threads = 3;
+		options.chunkBytes = 16;
+		options.maxRecordBytes = 64;
+		return options;
+	}
+}
+
+TEST_CASE("check chunks", "[uCSV][Check]")
+{
+	// most records straddle the boundaries of the chunks, some of them within quotes
+	string_t data = "id,text\n";
+	std::vector<std::uint64_t> offsets;
+	constexpr std::size_t n = 300;
+	for(std::size_t id = 0; id < n; ++id)
+	{
+		offsets.push_back(data.size());
+		data += std::to_string(id) + (id % 3 ? ",\"quoted\nline, " + std::to_string(id) + "\"" : ",plain");
+		if(id == 57 || id == 211)
+			data += ",extra";
+		data += id % 2 ? "\r\n" : "\n";
+	}
+
+	std::istringstream input(data);
+	const FileResult result = checkFile<DefaultDelimiter>(input, true, smallChunks());
+	CHECK(result.bytes == data.size());
+	CHECK(result.expectedColumns == 2);
+	CHECK(result.names == std::vector<string_t>{ "id", "text" });
+	CHECK(result.total.records == n + 1);
+	CHECK(result.total.counts[static_cast<std::size_t>(Problem::columns)] == 2);
+	REQUIRE(result.total.columns.size() == 2);
+	CHECK(result.total.columns[0].types[static_cast<std::size_t>(CellType::integer)] == n - 2);
+
+	// the records and offsets of the errors are those within the file, not within their chunk
+	REQUIRE(result.total.errors.size() == 2);
+	CHECK(result.total.errors[0].problem == Problem::columns);
+	CHECK(result.total.errors[0].record == 57 + 2);
+	CHECK(result.total.errors[0].offset == offsets[57]);
+	CHECK(result.total.errors[0].columns == 3);
+	CHECK(result.total.errors[1].record == 211 + 2);
+	CHECK(result.total.errors[1].offset == offsets[211]);
+}
+
+TEST_CASE("check oversized records", "[uCSV][Check]")
+{
+	// an unterminated quote is skipped up to the next line break once it exceeds the maximum length of a record
+	const string_t data = "a,b\n1,2\n\"x" + string_t(100, 'y') + "\n3,4\n5,6\n";
+	std::istringstream input(data);
+	const FileResult result = checkFile<DefaultDelimiter>(input, true, smallChunks());
+	CHECK(result.total.records == 5);
+	CHECK(result.total.counts[static_cast<std::size_t>(Problem::oversized)] == 1);
+	REQUIRE(result.total.errors.size() == 1);
+	CHECK(result.total.errors[0].problem == Problem::oversized);
+	CHECK(result.total.errors[0].record == 3);
+	CHECK(result.total.errors[0].offset == 8);
+	CHECK(result.total.columns[0].types[static_cast<std::size_t>(CellType::integer)] == 3);
+
+	std::istringstream malformed("\"a\"b,c\n1,2\n");
+	CHECK_THROWS_AS(checkFile<DefaultDelimiter>(malformed, true, smallChunks()), MalformedFile);
+}
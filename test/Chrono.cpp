@@ -0,0 +1,133 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+
+namespace
+{
+	template<typename T>
+	T parse(string_view_t cell)
+	{
+		Deserializer deserializer(1, nullptr, &cell);
+		T result{};
+		deserialize(deserializer, result);
+		return result;
+	}
+	template<typename T>
+	bool fails(string_view_t cell)
+	{
+		try
+		{
+			parse<T>(cell);
+		}
+		catch(std::runtime_error const&)
+		{
+			return true;
+		}
+		return false;
+	}
+}
+
+TEST_CASE("time points", "[uCSV][Chrono]")
+{
+	using namespace std::chrono;
+	using sys_seconds = time_point<system_clock, seconds>;
+	using sys_nanoseconds = time_point<system_clock, nanoseconds>;
+	const auto epoch = [](auto count) { return count.time_since_epoch().count(); };
+
+	CHECK(epoch(parse<sys_seconds>("1970-01-01")) == 0);
+	CHECK(epoch(parse<sys_seconds>("1970-01-01T00:00:00Z")) == 0);
+	CHECK(epoch(parse<sys_seconds>("2000-03-01 12:34:56")) == 951914096);
+	CHECK(epoch(parse<sys_seconds>("2020-02-29T23:59:59Z")) == 1583020799);
+	CHECK(epoch(parse<sys_seconds>("1969-12-31T23:59:59")) == -1);
+	CHECK(epoch(parse<sys_seconds>("2020-01-01T01:00:00+01:00")) == 1577836800);
+	CHECK(epoch(parse<sys_seconds>("2019-12-31T22:30:00-01:30")) == 1577836800);
+	CHECK(epoch(parse<sys_seconds>("2020-01-01T05:00:00+0500")) == 1577836800);
+	CHECK(epoch(parse<sys_seconds>("2020-01-01T05:00:00+05")) == 1577836800);
+	CHECK(epoch(parse<sys_nanoseconds>("2020-01-01T00:00:00.123456789Z")) == 1577836800123456789);
+	CHECK(epoch(parse<sys_nanoseconds>("2020-01-01T00:00:00.5")) == 1577836800500000000);
+	CHECK(epoch(parse<sys_nanoseconds>("2020-01-01T00:00:00.1234567891")) == 1577836800123456789);
+	CHECK(epoch(parse<sys_seconds>("2020-01-01T00:00:00.999")) == 1577836800);
+	CHECK(epoch(parse<time_point<system_clock, milliseconds>>("1969-12-31T23:59:59.9995")) == -1);
+	CHECK(parse<system_clock::time_point>("2020-01-01") == system_clock::time_point(seconds(1577836800)));
+
+	CHECK(fails<sys_seconds>(""));
+	CHECK(fails<sys_seconds>("2020-1-01"));
+	CHECK(fails<sys_seconds>("2020/01/01"));
+	CHECK(fails<sys_seconds>("2020-13-01"));
+	CHECK(fails<sys_seconds>("2019-02-29"));
+	CHECK(fails<sys_seconds>("2020-01-00"));
+	CHECK(fails<sys_seconds>("2020-01-01T"));
+	CHECK(fails<sys_seconds>("2020-01-01T24:00:00"));
+	CHECK(fails<sys_seconds>("2020-01-01T12:60:00"));
+	CHECK(fails<sys_seconds>("2020-01-01T12:00:0a"));
+	CHECK(fails<sys_seconds>("2020-01-01T12:00:00."));
+	CHECK(fails<sys_seconds>("2020-01-01T12:00:00+1:00"));
+	CHECK(fails<sys_seconds>("2020-01-01T12:00:00 UTC"));
+	CHECK(fails<sys_seconds>("2020-01-01x"));
+}
+
+TEST_CASE("durations", "[uCSV][Chrono]")
+{
+	using namespace std::chrono;
+
+	CHECK(parse<seconds>("00:00:00") == seconds(0));
+	CHECK(parse<seconds>("01:02:03") == seconds(3723));
+	CHECK(parse<seconds>("-01:02:03") == seconds(-3723));
+	CHECK(parse<minutes>("123:30:00") == minutes(123 * 60 + 30));
+	CHECK(parse<milliseconds>("00:00:01.25") == milliseconds(1250));
+	CHECK(parse<nanoseconds>("00:00:00.000000001") == nanoseconds(1));
+	CHECK(parse<seconds>("PT1H30M") == seconds(5400));
+	CHECK(parse<seconds>("P1W2D") == seconds(9 * 86400));
+	CHECK(parse<milliseconds>("P1DT0.5S") == milliseconds(86400500));
+	CHECK(parse<duration<double>>("PT1.5S").count() == 1.5);
+	CHECK(parse<seconds>("-PT10S") == seconds(-10));
+
+	CHECK(fails<seconds>(""));
+	CHECK(fails<seconds>("1:00:00"));
+	CHECK(fails<seconds>("01:00"));
+	CHECK(fails<seconds>("01:00:00x"));
+	CHECK(fails<seconds>("P"));
+	CHECK(fails<seconds>("P1M"));
+	CHECK(fails<seconds>("PT1D"));
+	CHECK(fails<seconds>("P1"));
+	CHECK(fails<seconds>("PT1.5H"));
+
+	// the value doesn't fit into 64 bits of nanoseconds
+	CHECK(fails<seconds>("P99999999999999999999D"));
+	CHECK(fails<seconds>("P106752D"));
+	CHECK(fails<seconds>("P106751DT86400S"));
+	CHECK(fails<seconds>("99999999999:00:00"));
+	CHECK(fails<seconds>("99999999999999999999999:00:00"));
+	CHECK(parse<hours>("2562047:00:00") == hours(2562047));
+}
+
+#if defined(__cpp_lib_chrono) && __cpp_lib_chrono >= 201907L
+TEST_CASE("dates", "[uCSV][Chrono]")
+{
+	using namespace std::chrono;
+	CHECK(parse<year_month_day>("2020-02-29") == year(2020) / February / 29);
+	CHECK(fails<year_month_day>("2020-02-30"));
+	CHECK(fails<year_month_day>("2020-02-29T00:00:00"));
+}
+#endif
+
+TEST_CASE("timestamps in rows", "[uCSV][Chrono]")
+{
+	using namespace std::chrono;
+	constexpr char_t data[] = "id,at,took\n1,2020-01-01T00:00:00Z,00:00:01.5\n";
+	Reader reader(std::begin(data), std::end(data) - 1, ErrorThrow{}, readHeader);
+	std::tuple<int, time_point<system_clock, seconds>, milliseconds> row;
+	REQUIRE(reader.fetch(row) == true);
+	CHECK(std::get<1>(row).time_since_epoch() == seconds(1577836800));
+	CHECK(std::get<2>(row) == milliseconds(1500));
+}
@@ -51,6 +51,7 @@ TEST_CASE("good combinatorial tests", "[uCSV][Combinatorial]")
 		"\"\r\"",
 		"\"\n\"",
 		"\"\r\n\"",
+		R"(",")",
 	};
 	constexpr std::size_t nIn = sizeof(in) / sizeof(*in);
 
@@ -68,6 +69,7 @@ TEST_CASE("good combinatorial tests", "[uCSV][Combinatorial]")
 		"\r",
 		"\n",
 		"\r\n",
+		",",
 	};
 	constexpr std::size_t nOut = sizeof(out) / sizeof(*out);
 
@@ -0,0 +1,96 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using row_t = std::vector<string_t>;
+
+namespace
+{
+	template<typename DialectT, typename DelimiterMatcherT = DefaultDelimiter>
+	std::vector<row_t> parse(string_view_t data, ErrorFlags& flags)
+	{
+		Reader reader(data.begin(), data.end(), ErrorFlags{}, DelimiterMatcherT{}, RawEncoding{}, DialectT{}, ignoreHeader);
+		std::vector<row_t> rows;
+		while(!reader.done())
+		{
+			row_t row;
+			if(reader.fetch(row))
+				rows.emplace_back(std::move(row));
+		}
+		flags = reader.errorHandler();
+		return rows;
+	}
+}
+
+TEST_CASE("quote character", "[uCSV][Dialect]")
+{
+	ErrorFlags flags;
+	CHECK(parse<Dialect<'\''>>("'a,b','c''d',\"e\"\n", flags) == std::vector<row_t>{ { "a,b", "c'd", "\"e\"" } });
+	CHECK(flags.good());
+	CHECK(parse<Dialect<'\''>, Delimiter<'"'>>("a\"'b\"'\n", flags) == std::vector<row_t>{ { "a", "b\"" } });
+	CHECK(flags.good());
+
+	CHECK(parse<Dialect<'\0'>>("\"a,b\"\n", flags) == std::vector<row_t>{ { "\"a", "b\"" } });
+	CHECK(flags.good());
+
+	// a Delimiter<'"'> with the default dialect fails to compile, custom matchers are checked at run time
+	const auto quoteMatcher = [](char_t c) { return c == ',' || c == '"'; };
+	const string_view_t data = "a,b\n";
+	CHECK_THROWS_AS(Reader(data.begin(), data.end(), ErrorFlags{}, quoteMatcher, ignoreHeader), std::invalid_argument);
+	const auto commentMatcher = [](char_t c) { return c == '#'; };
+	CHECK_THROWS_AS(Reader(data.begin(), data.end(), ErrorFlags{}, commentMatcher, RawEncoding{}, Dialect<'"', Escape::doubled, '#'>{}, ignoreHeader), std::invalid_argument);
+}
+
+TEST_CASE("backslash escapes", "[uCSV][Dialect]")
+{
+	using dialect_t = Dialect<'"', Escape::backslash>;
+	ErrorFlags flags;
+	CHECK(parse<dialect_t>("\"a\\\"b\",c\\,d,e\\\\\n\"x\\\ny\",\\\",\n", flags) == std::vector<row_t>{ { "a\"b", "c,d", "e\\" }, { "x\ny", "\"", "" } });
+	CHECK(flags.good());
+
+	// a doubled quote isn't an escape sequence
+	CHECK(parse<dialect_t>("\"a\"\"b\",c\nd,e\n", flags) == std::vector<row_t>{ { "d", "e" } });
+	CHECK(flags.badCell());
+	CHECK(parse<dialect_t>("a,b\\", flags).empty());
+	CHECK(flags.unexpectedEnd());
+}
+
+TEST_CASE("comments", "[uCSV][Dialect]")
+{
+	using dialect_t = Dialect<'"', Escape::doubled, '#'>;
+	ErrorFlags flags;
+	CHECK(parse<dialect_t>("# head\n#\r\na,\"#b\"\n#x,\"y\n\"#c\",d\r\n# tail", flags) == std::vector<row_t>{ { "a", "#b" }, { "#c", "d" } });
+	CHECK(flags.good());
+
+	std::istringstream stream("#comment\nA,B\n#comment\n1,2\n");
+	Reader reader(stream, ErrorFlags{}, DefaultDelimiter{}, RawEncoding{}, dialect_t{}, readHeader);
+	CHECK(reader.header(1) == "B");
+	row_t row;
+	CHECK(reader.fetch(row));
+	CHECK(row == row_t{ "1", "2" });
+	CHECK(reader.done());
+}
+
+TEST_CASE("trimming", "[uCSV][Dialect]")
+{
+	using dialect_t = Dialect<'"', Escape::doubled, '\0', true>;
+	ErrorFlags flags;
+	CHECK(parse<dialect_t>(" a , b\tc\t, \" d \" \n,  ,\" \"  ", flags) == std::vector<row_t>{ { "a", "b\tc", " d " }, { "", "", " " } });
+	CHECK(flags.good());
+
+	using escaping_t = Dialect<'"', Escape::backslash, '\0', true>;
+	CHECK(parse<escaping_t>(" a\\  ,b", flags) == std::vector<row_t>{ { "a ", "b" } });
+	CHECK(flags.good());
+}
@@ -0,0 +1,118 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Dictionary.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+#include <thread>
+#include <string>
+#include <tuple>
+
+TEST_CASE("dictionary", "[uCSV][Dictionary]")
+{
+	Dictionary<> dict;
+	CHECK(dict.size() == 1);
+	CHECK(dict.find("") == 0u);
+	CHECK(dict.intern("DE") == 1);
+	CHECK(dict.intern("FR") == 2);
+	CHECK(dict.intern("DE") == 1);
+	CHECK(dict.find("IT").has_value() == false);
+	CHECK(dict[2] == "FR");
+
+	// enough values to force the index to grow several times
+	for(int i = 0; i < 1000; ++i)
+		CHECK(dict.intern(std::to_string(i)) == static_cast<std::uint32_t>(i + 3));
+	CHECK(dict[3] == "0");
+	CHECK(dict[1002] == "999");
+	CHECK(dict.size() == 1003);
+
+	Dictionary<std::uint8_t> tiny;
+	for(int i = 1; i < 255; ++i)
+		tiny.intern(std::to_string(i));
+	CHECK_THROWS_AS(tiny.intern("overflow"), std::length_error);
+}
+
+TEST_CASE("dictionary concurrency", "[uCSV][Dictionary]")
+{
+	Dictionary<> dict;
+	constexpr int values = 500;
+	std::vector<std::vector<std::uint32_t>> codes(4);
+	std::vector<std::thread> threads;
+	for(auto& result : codes)
+		threads.emplace_back([&dict, &result]
+		{
+			for(int i = 0; i < values; ++i)
+				result.push_back(dict.intern(std::to_string(i % 100)));
+		});
+	for(auto& thread : threads)
+		thread.join();
+
+	CHECK(dict.size() == 101);
+	for(auto const& result : codes)
+		CHECK(result == codes.front());
+	for(int i = 0; i < 100; ++i)
+		CHECK(dict[codes.front()[i]] == std::to_string(i));
+}
+
+TEST_CASE("interned strings", "[uCSV][Dictionary]")
+{
+	struct Country;
+	using country_t = InternedString<Country>;
+
+	constexpr char_t data[] = "DE,FR,\nFR,DE,\"DE\"\n";
+	Reader reader(std::begin(data), std::end(data) - 1, ErrorThrow{}, ignoreHeader);
+	std::vector<std::vector<country_t>> rows;
+	reader.fetchAll(std::back_inserter(rows));
+	REQUIRE(rows.size() == 2);
+	CHECK(rows[0][0] == rows[1][1]);
+	CHECK(rows[0][1] == rows[1][0]);
+	CHECK(rows[0][0] != rows[0][1]);
+	CHECK(rows[1][2] == rows[0][0]);
+	CHECK(rows[0][2] == country_t());
+	CHECK(rows[0][2].code() == 0);
+	CHECK(rows[0][0].view() == "DE");
+	CHECK(rows[0][0].view().data() == rows[1][2].view().data());
+	CHECK(country_t::dictionary().size() == 3);
+	CHECK(std::hash<country_t>()(rows[0][1]) == std::hash<country_t>()(rows[1][0]));
+}
+
+TEST_CASE("coded strings", "[uCSV][Dictionary]")
+{
+	// every column has its own dictionary, which the rows are bound to
+	Dictionary<> countries;
+	Dictionary<std::uint8_t> colors;
+	using row_t = std::tuple<int, Coded<>, Coded<std::uint8_t>>;
+
+	const string_view_t data = "1,DE,red\n2,FR,red\n3,DE,\"blue\"\n";
+	Reader reader(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+	row_t row(0, Coded<>(countries), Coded<std::uint8_t>(colors));
+	std::vector<row_t> rows;
+	while(!reader.done())
+		if(reader.fetch(row))
+			rows.push_back(row);
+	REQUIRE(rows.size() == 3);
+	CHECK(std::get<1>(rows[0]) == std::get<1>(rows[2]));
+	CHECK(std::get<1>(rows[0]) != std::get<1>(rows[1]));
+	CHECK(std::get<1>(rows[1]).view() == "FR");
+	CHECK(std::get<2>(rows[2]).code() == 2);
+	CHECK(std::get<2>(rows[2]).dictionary() == &colors);
+	CHECK(countries.size() == 3);
+	CHECK(colors.size() == 3);
+	CHECK(std::hash<Coded<>>()(std::get<1>(rows[0])) == std::hash<Coded<>>()(std::get<1>(rows[2])));
+
+	// equal codes of different dictionaries aren't equal
+	Dictionary<> other;
+	CHECK(Coded<>(countries, "DE") == std::get<1>(rows[0]));
+	CHECK(Coded<>(other, "IT") != Coded<>(countries, "DE"));
+
+	Reader unbound(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+	row_t empty;
+	CHECK_THROWS_AS(unbound.fetch(empty), std::logic_error);
+}
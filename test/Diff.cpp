@@ -0,0 +1,158 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Diff.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <tuple>
+#include <vector>
+
+TEST_CASE("row hash", "[uCSV][Diff]")
+{
+	const string_view_t data = "a,b\n\"a\",b\n\"a,b\",\na,\"b,\"\na,c\n";
+	Reader reader(data.begin(), data.end(), ignoreHeader);
+	std::vector<std::uint64_t> hashes;
+	while(!reader.done())
+		if(reader.fetch())
+			hashes.push_back(reader.rowHash());
+	REQUIRE(hashes.size() == 5);
+	CHECK(hashes[0] == hashes[1]);
+	CHECK(hashes[2] != hashes[3]);
+	CHECK(hashes[0] != hashes[4]);
+}
+
+TEST_CASE("diff", "[uCSV][Diff]")
+{
+	const string_view_t before = "id,name,value\n1,one,1\n2,two,2\n3,three,3\n4,four,4\n";
+	const string_view_t after = "id,name,value\n4,four,4\n\"2\",\"two\",2\n3,three,33\n5,five,5\n";
+
+	Reader oldReader(before.begin(), before.end(), ErrorThrow{}, readHeader);
+	Reader newReader(after.begin(), after.end(), ErrorThrow{}, readHeader);
+	using change_t = std::tuple<Change, string_t, string_t>;
+	std::vector<change_t> changes;
+	const DiffStatistics statistics = diff(oldReader, newReader, 0, [&changes](Change change, Deserializer* old, Deserializer* current)
+	{
+		string_t oldValue, newValue;
+		if(old)
+		{
+			CHECK(old->name() == "id");
+			oldValue = string_t(old->cell(0)) + ":" + string_t(old->cell(2));
+		}
+		if(current)
+			newValue = string_t(current->cell(0)) + ":" + string_t(current->cell(2));
+		changes.emplace_back(change, oldValue, newValue);
+	});
+
+	CHECK(changes == std::vector<change_t>{
+		{ Change::changed, "3:3", "3:33" },
+		{ Change::inserted, "", "5:5" },
+		{ Change::deleted, "1:1", "" },
+	});
+	CHECK(statistics.inserted == 1);
+	CHECK(statistics.deleted == 1);
+	CHECK(statistics.changed == 1);
+	CHECK(statistics.unchanged == 2);
+
+	const string_view_t duplicate = "1,a\n1,b\n";
+	Reader duplicateReader(duplicate.begin(), duplicate.end(), ignoreHeader);
+	Reader emptyReader(after.end(), after.end(), ignoreHeader);
+	CHECK_THROWS_AS(diff(duplicateReader, emptyReader, 0, [](Change, Deserializer*, Deserializer*) {}), std::runtime_error);
+}
+
+TEST_CASE("diff table", "[uCSV][Diff]")
+{
+	// entries whose hashes collide are told apart by the predicate
+	Detail::DiffTable<int> table;
+	const auto never = [](auto const&) { return false; };
+	for(int i = 0; i < 100; ++i)
+		CHECK(table.insert(i % 3, i, i, static_cast<std::size_t>(i), never));
+	CHECK(table.insert(1, 0, 0, 0, [](auto const& entry) { return entry.position == 40; }) == false);
+	for(int i = 0; i < 100; ++i)
+	{
+		auto* const entry = table.find(i % 3, [i](auto const& candidate) { return candidate.position == i; });
+		REQUIRE(entry);
+		CHECK(entry->row == static_cast<std::uint64_t>(i));
+	}
+	CHECK(table.find(0, never) == nullptr);
+	CHECK(table.find(7, [](auto const&) { return true; }) == nullptr);
+}
+
+TEST_CASE("diff forward iterators", "[uCSV][Diff]")
+{
+	const string_view_t data = "id,value\n1,a\n2,b\n3,c\n";
+	const std::list<char_t> before(data.begin(), data.end());
+	const string_view_t after = "id,value\n3,c\n2,x\n";
+	const std::list<char_t> current(after.begin(), after.end());
+	Reader oldReader(before.begin(), before.end(), ErrorThrow{}, readHeader);
+	Reader newReader(current.begin(), current.end(), ErrorThrow{}, readHeader);
+	std::vector<string_t> changes;
+	const DiffStatistics statistics = diff(oldReader, newReader, 0, [&changes](Change, Deserializer* old, Deserializer* current)
+	{
+		changes.push_back(string_t(old ? old->cell(1) : "") + ">" + string_t(current ? current->cell(1) : ""));
+	});
+	CHECK(changes == std::vector<string_t>{ "b>x", "a>" });
+	CHECK(statistics.unchanged == 1);
+}
+
+TEST_CASE("diff partitioned", "[uCSV][Diff]")
+{
+	string_t before = "id,value\n", after = "id,value\n";
+	for(int i = 0; i < 1000; ++i)
+	{
+		if(i % 7 != 0)
+			before += std::to_string(i) + "," + std::to_string(i) + "\n";
+		if(i % 5 != 0)
+			after += std::to_string(i) + "," + std::to_string(i % 11 == 0 ? -i : i) + "\n";
+	}
+
+	using change_t = std::tuple<Change, string_t, string_t>;
+	const auto run = [&](DiffOptions const& options, DiffStatistics& statistics)
+	{
+		Reader oldReader(before.cbegin(), before.cend(), ErrorThrow{}, readHeader);
+		Reader newReader(after.cbegin(), after.cend(), ErrorThrow{}, readHeader);
+		std::vector<change_t> changes;
+		statistics = diff(oldReader, newReader, 0, [&changes](Change change, Deserializer* old, Deserializer* current)
+		{
+			if(old)
+				CHECK(old->name() == "id");
+			changes.emplace_back(change, old ? string_t(old->cell(1)) : "", current ? string_t(current->cell(1)) : "");
+		}, options);
+		std::sort(changes.begin(), changes.end());
+		return changes;
+	};
+
+	DiffStatistics inMemory, partitioned, resplit;
+	const std::vector<change_t> expected = run({}, inMemory);
+	CHECK(inMemory.partitions == 0);
+	DiffOptions options;
+	options.memory = 64 << 10;
+	options.partitions = 4;
+	CHECK(run(options, partitioned) == expected);
+	CHECK(partitioned.partitions == 4);
+	// partitions of about 200 rows don't fit into 256 bytes either and are split until the last level
+	options.memory = 256;
+	CHECK(run(options, resplit) == expected);
+	CHECK(resplit.partitions == 64);
+	for(DiffStatistics const& statistics : { partitioned, resplit })
+	{
+		CHECK(statistics.inserted == inMemory.inserted);
+		CHECK(statistics.deleted == inMemory.deleted);
+		CHECK(statistics.changed == inMemory.changed);
+		CHECK(statistics.unchanged == inMemory.unchanged);
+	}
+
+	const string_view_t duplicate = "1,a\n2,b\n1,b\n";
+	Reader duplicateReader(duplicate.begin(), duplicate.end(), ignoreHeader);
+	Reader emptyReader(duplicate.end(), duplicate.end(), ignoreHeader);
+	options.memory = 0;
+	CHECK_THROWS_AS(diff(duplicateReader, emptyReader, 0, [](Change, Deserializer*, Deserializer*) {}, options), std::runtime_error);
+}
@@ -0,0 +1,109 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+#include <sstream>
+#include <string>
+
+using row_t = std::vector<string_t>;
+
+namespace
+{
+	struct ErrorRecord : ErrorIgnore
+	{
+		std::vector<std::pair<unsigned int, unsigned int>> badEncodings;
+
+		void raiseBadEncoding(unsigned int column, unsigned int row)
+		{
+			badEncodings.emplace_back(column, row);
+		}
+	};
+}
+
+TEST_CASE("byte order mark", "[uCSV][Encoding]")
+{
+	const string_t data = "\xEF\xBB\xBF" "A,B\na,b\n";
+
+	SECTION("raw")
+	{
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, readHeader);
+		CHECK(reader.header(0) == "\xEF\xBB\xBF" "A");
+	}
+	SECTION("keep")
+	{
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, DefaultDelimiter{}, Utf8<Bom::keep>{}, readHeader);
+		CHECK(reader.header(0) == "\xEF\xBB\xBF" "A");
+	}
+	SECTION("strip")
+	{
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, DefaultDelimiter{}, Utf8<>{}, readHeader);
+		CHECK(reader.header(0) == "A");
+		row_t row;
+		CHECK(reader.fetch(row) == true);
+		CHECK(row == row_t{ "a", "b" });
+	}
+	SECTION("strip from stream")
+	{
+		std::istringstream stream(data);
+		Reader reader(stream, ErrorThrow{}, DefaultDelimiter{}, Utf8<Bom::strip, false>{}, readHeader);
+		CHECK(reader.header(0) == "A");
+		CHECK(reader.header(1) == "B");
+	}
+	SECTION("partial match from stream")
+	{
+		// U+FEFE shares its first two bytes with the byte order mark
+		std::istringstream stream("\xEF\xBB\xBE" ",B\n");
+		Reader reader(stream, ErrorThrow{}, DefaultDelimiter{}, Utf8<>{}, readHeader);
+		CHECK(reader.header(0) == "\xEF\xBB\xBE");
+		CHECK(reader.header(1) == "B");
+		CHECK(reader.done());
+
+		std::istringstream tiny("\xEF");
+		Reader reader2(tiny, ErrorFlags{}, DefaultDelimiter{}, Utf8<Bom::strip, false>{}, ignoreHeader);
+		row_t row;
+		CHECK(reader2.fetch(row) == true);
+		CHECK(row == row_t{ "\xEF" });
+	}
+}
+
+TEST_CASE("UTF-8 validation", "[uCSV][Encoding]")
+{
+	const string_t data =
+		"\xC3\xA4,\xE2\x82\xAC,\xF0\x9F\x98\x80\n" // valid
+		"a,\xC3,b\n" // truncated sequence
+		"a,b,\xC0\xAF\n" // overlong
+		"\xED\xA0\x80,b,c\n" // surrogate
+		"\xF4\x90\x80\x80,b,c\n" // beyond U+10FFFF
+		"a,\"\xE2\x82\n\",c\n" // truncated by a quoted newline
+		"x,y,\xE2\x82";
+
+	Reader reader(data.begin(), data.end(), ErrorRecord{}, DefaultDelimiter{}, Utf8<>{}, ignoreHeader);
+	row_t row;
+	CHECK(reader.fetch(row) == true);
+	CHECK(row == row_t{ "\xC3\xA4", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" });
+	while(!reader.done())
+		CHECK(reader.fetch(row) == false);
+
+	using error_t = std::pair<unsigned int, unsigned int>;
+	CHECK(reader.errorHandler().badEncodings == std::vector<error_t>{ { 1, 1 }, { 2, 1 }, { 0, 1 }, { 0, 1 }, { 1, 1 }, { 2, 1 } });
+}
+
+TEST_CASE("trailing delimiter", "[uCSV][Encoding]")
+{
+	constexpr char_t data[] = "a,b\nc,";
+	Reader reader(std::begin(data), std::end(data) - 1, ErrorThrow{}, ignoreHeader);
+	row_t row;
+	CHECK(reader.fetch(row) == true);
+	CHECK(reader.fetch(row) == true);
+	CHECK(row == row_t{ "c", "" });
+	CHECK(reader.done());
+}
@@ -10,6 +10,11 @@ using namespace uCSV;
 
 #include <catch2/catch.hpp>
 
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
 TEST_CASE("needsEscaping", "[uCSV][Escape]")
 {
 	CHECK(needsEscaping("a") == false);
@@ -32,6 +37,43 @@ TEST_CASE("escape", "[uCSV][Escape]")
 	CHECK(escapeToStr("\r\n") == "\"\r\n\"");
 }
 
+TEST_CASE("contiguous escaping", "[uCSV][Escape]")
+{
+	const string_t text = "0123456789abcdef\"ghijklmn,opqrstuvwxyz\"\"";
+	CHECK(needsEscaping(string_view_t(text).substr(0, 16)) == false);
+	CHECK(needsEscaping(string_view_t(text).substr(0, 17)) == true);
+	CHECK(needsEscaping(string_t(text, 18, 10)) == true);
+	CHECK(needsEscaping(string_t(text, 18, 10), Delimiter<';'>()) == false);
+	CHECK(needsEscaping(string_t("abcdefgh;"), Delimiter<';'>()) == true);
+	CHECK(needsEscaping(string_t("abcdefghijklm\n")) == true);
+	CHECK(needsEscaping(string_t("abcdefgh|"), [](char_t c) noexcept { return c == '|'; }) == true);
+	CHECK(needsEscaping(std::vector<char_t>{ 'a', 'b' }) == false);
+
+	CHECK(escapedSize(text) == text.size() + 3 + 2);
+	CHECK(escapeToStr(text) == "\"0123456789abcdef\"\"ghijklmn,opqrstuvwxyz\"\"\"\"\"");
+	CHECK(escapeToStr(string_view_t()) == "\"\"");
+	CHECK(escapeToStr(string_t("ab\0\"c", 5)) == "\"ab\"");
+	CHECK(escapedSize(string_t("ab\0\"c", 5)) == 4);
+
+	std::mt19937 rng(42);
+	const char_t alphabet[] = { 'a', 'b', '"', ',', '\n', '\r', ' ' };
+	for(std::size_t size = 0; size < 40; ++size)
+	{
+		string_t random(size, 'a');
+		for(char_t& c : random)
+			c = alphabet[rng() % std::size(alphabet)];
+		string_t expected;
+		escape(random.begin(), random.end(), std::back_inserter(expected));
+		CHECK(escapeToStr(random) == expected);
+		CHECK(escapedSize(random) == expected.size());
+		string_t viaIterator;
+		escape(string_view_t(random), std::back_inserter(viaIterator));
+		CHECK(viaIterator == expected);
+		CHECK(needsEscaping(random) == needsEscaping(random.begin(), random.end()));
+		CHECK(needsEscaping(random, Delimiter<';', ' '>()) == needsEscaping(random.begin(), random.end(), Delimiter<';', ' '>()));
+	}
+}
+
 TEST_CASE("unescape", "[uCSV][Escape]")
 {
 	// TODO:
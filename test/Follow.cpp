@@ -0,0 +1,105 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Follow.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <string>
+
+namespace
+{
+	void append(std::filesystem::path const& path, char const* data)
+	{
+		std::ofstream file(path, std::ofstream::binary | std::ofstream::app);
+		file << data;
+	}
+}
+
+TEST_CASE("follow", "[uCSV][Follow]")
+{
+	using row_t = std::vector<string_t>;
+	const auto path = std::filesystem::temp_directory_path() / "uCSV_follow_test.csv";
+	std::filesystem::remove(path);
+
+	Follower follower(path, ErrorFlags{}, Delimiter<','>{}, readHeader);
+	std::vector<row_t> rows;
+	const auto collect = [&rows](Deserializer& data)
+	{
+		row_t row;
+		deserialize(data, row);
+		rows.emplace_back(std::move(row));
+	};
+
+	SECTION("append")
+	{
+		CHECK(follower.poll(collect) == 0);
+
+		append(path, "A,B\na,b\n");
+		CHECK(follower.poll(collect) == 1);
+		REQUIRE(follower.reader() != nullptr);
+		CHECK(follower.reader()->header(1) == "B");
+
+		append(path, "c,\"d");
+		CHECK(follower.poll(collect) == 0);
+		append(path, "\nd\"\r");
+		CHECK(follower.poll(collect) == 0);
+		append(path, "\ne,f\n");
+		CHECK(follower.poll(collect) == 2);
+		CHECK(rows == std::vector<row_t>{ { "a", "b" }, { "c", "d\nd" }, { "e", "f" } });
+
+		append(path, "g\nh,i\n");
+		CHECK(follower.poll(collect) == 1);
+		CHECK(follower.errorHandler().incorrectColumns() == true);
+		CHECK(rows.back() == row_t{ "h", "i" });
+		CHECK(follower.delivered() == 4);
+	}
+	SECTION("wait")
+	{
+		append(path, "A,B\n");
+		std::thread writer([&path]
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			append(path, "a,b\n");
+		});
+		const auto start = std::chrono::steady_clock::now();
+		CHECK(follower.poll(collect, std::chrono::seconds(10)) == 1);
+		CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+		writer.join();
+		CHECK(rows == std::vector<row_t>{ { "a", "b" } });
+	}
+	SECTION("truncation")
+	{
+		append(path, "A,B\na,b\nc,d\n");
+		CHECK(follower.poll(collect) == 2);
+		std::filesystem::resize_file(path, 0);
+		append(path, "X,Y\nx,y\n");
+		CHECK(follower.poll(collect) == 1);
+		CHECK(follower.reader()->header(0) == "X");
+		CHECK(rows.back() == row_t{ "x", "y" });
+	}
+	SECTION("rotation")
+	{
+		const auto old = std::filesystem::temp_directory_path() / "uCSV_follow_test.csv.1";
+		append(path, "A,B\na,b\n");
+		CHECK(follower.poll(collect) == 1);
+		append(path, "c,d");
+		std::filesystem::rename(path, old);
+		append(path, "X,Y,Z\nx,y,z\n");
+		CHECK(follower.poll(collect) == 2);
+		CHECK(rows == std::vector<row_t>{ { "a", "b" }, { "c", "d" }, { "x", "y", "z" } });
+		CHECK(follower.errorHandler().good() == true);
+		std::filesystem::remove(old);
+	}
+
+	std::filesystem::remove(path);
+}
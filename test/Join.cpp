@@ -0,0 +1,157 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Join.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	using Pairs = std::vector<std::pair<string_t, string_t>>;
+
+	// facts reference the dimension by the cell in column 1; some reference none, the empty key and duplicates included
+	struct Tables
+	{
+		string_t facts = "fact,dimension\n";
+		string_t dimensions = "dimension,name\n";
+		Pairs inner;
+		std::size_t unmatched = 0;
+	};
+	Tables makeTables(int facts, int dimensions)
+	{
+		Tables tables;
+		for(int i = 0; i < dimensions; ++i)
+		{
+			tables.dimensions += std::to_string(i) + ",\"dim " + std::to_string(i) + "\"\n";
+			if(i % 10 == 3)
+				tables.dimensions += std::to_string(i) + ",\"dup " + std::to_string(i) + "\"\n";
+		}
+		tables.dimensions += ",empty\n";
+		for(int i = 0; i < facts; ++i)
+		{
+			const int dimension = (i * 7) % (dimensions + 5);
+			const string_t key = i % 13 == 0 ? string_t() : std::to_string(dimension);
+			tables.facts += "f" + std::to_string(i) + ',' + key + '\n';
+			if(key.empty() || dimension >= dimensions)
+				++tables.unmatched;
+			else
+			{
+				tables.inner.emplace_back("f" + std::to_string(i), "dim " + std::to_string(dimension));
+				if(dimension % 10 == 3)
+					tables.inner.emplace_back("f" + std::to_string(i), "dup " + std::to_string(dimension));
+			}
+		}
+		std::sort(tables.inner.begin(), tables.inner.end());
+		return tables;
+	}
+
+	struct Collector
+	{
+		Pairs pairs;
+		std::size_t unmatched = 0;
+		void operator()(Deserializer& left, Deserializer* right)
+		{
+			if(!right)
+			{
+				++unmatched;
+				return;
+			}
+			CHECK(left.cell(1) == right->cell(0));
+			CHECK(right->name() == "dimension");
+			string_t fact, name;
+			deserializeMany(left, fact);
+			right->next();
+			deserializeMany(*right, name);
+			pairs.emplace_back(std::move(fact), std::move(name));
+		}
+	};
+
+	string_t sorted(string_t const& csv, std::size_t column)
+	{
+		std::istringstream input(csv);
+		std::ostringstream output;
+		externalSort(input, output, { { column, ColumnType::int64 } }, readHeader);
+		return output.str();
+	}
+}
+
+TEST_CASE("hash join", "[uCSV][Join]")
+{
+	const Tables tables = makeTables(5000, 300);
+	for(const std::size_t memory : { std::size_t(1) << 20, std::size_t(2000), std::size_t(0) })
+	{
+		for(const JoinType type : { JoinType::inner, JoinType::left })
+		{
+			std::istringstream facts(tables.facts);
+			std::istringstream dimensions(tables.dimensions);
+			Reader left(facts, ErrorThrow{}, readHeader);
+			Reader right(dimensions, ErrorThrow{}, readHeader);
+			JoinOptions options;
+			options.type = type;
+			options.memory = memory;
+			options.partitions = 4;
+			Collector collector;
+			const JoinStatistics result = hashJoin(left, right, 1, 0, collector, options);
+			std::sort(collector.pairs.begin(), collector.pairs.end());
+			CHECK(collector.pairs == tables.inner);
+			CHECK(result.matches == tables.inner.size());
+			CHECK(result.leftRows == 5000);
+			CHECK(result.rightRows == 300 + 30 + 1);
+			CHECK(collector.unmatched == (type == JoinType::left ? tables.unmatched : 0));
+			CHECK(result.unmatched == collector.unmatched);
+			if(memory > 10000)
+				CHECK(result.partitions == 0);
+			else
+				CHECK(result.partitions >= 4);
+		}
+	}
+}
+
+TEST_CASE("merge join", "[uCSV][Join]")
+{
+	const Tables tables = makeTables(5000, 300);
+	const string_t facts = sorted(tables.facts, 1);
+	const string_t dimensions = sorted(tables.dimensions, 0);
+	for(const JoinType type : { JoinType::inner, JoinType::left })
+	{
+		Reader left(facts.begin(), facts.end(), ErrorThrow{}, readHeader);
+		Reader right(dimensions.begin(), dimensions.end(), ErrorThrow{}, readHeader);
+		Collector collector;
+		const SortKey key = { 0, ColumnType::int64 };
+		const JoinStatistics result = mergeJoin(left, right, SortKey{ 1, ColumnType::int64 }, key, collector, type);
+		std::sort(collector.pairs.begin(), collector.pairs.end());
+		CHECK(collector.pairs == tables.inner);
+		CHECK(result.matches == tables.inner.size());
+		CHECK(collector.unmatched == (type == JoinType::left ? tables.unmatched : 0));
+	}
+
+	// the order is verified
+	Reader left(tables.facts.begin(), tables.facts.end(), ErrorThrow{}, readHeader);
+	Reader right(dimensions.begin(), dimensions.end(), ErrorThrow{}, readHeader);
+	CHECK_THROWS_AS(mergeJoin(left, right, SortKey{ 1, ColumnType::int64 }, SortKey{ 0, ColumnType::int64 }, Collector{}), std::runtime_error);
+	CHECK_THROWS_AS(mergeJoin(left, right, SortKey{ 1 }, SortKey{ 0, ColumnType::int64 }, Collector{}), std::invalid_argument);
+}
+
+TEST_CASE("join writer", "[uCSV][Join]")
+{
+	const string_view_t facts = "1,x\n2,y\n3,z\n";
+	const string_view_t dimensions = "1,\"a,b\"\n3,c\n";
+	Reader left(facts.begin(), facts.end(), ErrorThrow{}, ignoreHeader);
+	Reader right(dimensions.begin(), dimensions.end(), ErrorThrow{}, ignoreHeader);
+	std::ostringstream output;
+	JoinOptions options;
+	options.type = JoinType::left;
+	hashJoin(left, right, 0, 0, JoinWriter(output, 2), options);
+	CHECK(output.str() == "1,x,1,\"a,b\"\n2,y,,\n3,z,3,c\n");
+}
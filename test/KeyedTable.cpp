@@ -0,0 +1,138 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/KeyedTable.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+TEST_CASE("keyed table", "[uCSV][KeyedTable]")
+{
+	constexpr int n = 10000;
+	string_t data = "name,id,value\n";
+	for(int i = 0; i < n; ++i)
+		data += "\"name " + std::to_string(i) + "\"," + std::to_string(i * 1024) + ',' + std::to_string(i) + ".5\n";
+
+	using row_t = std::tuple<string_t, int, double>;
+	{
+		std::istringstream stream(data);
+		Reader reader(stream, ErrorThrow{}, readHeader);
+		const auto table = keyedTable<int, row_t>(reader, 1);
+		REQUIRE(table.size() == n);
+		CHECK(table.keys()[3] == 3 * 1024);
+		CHECK(table.at(5 * 1024) == row_t{ "name 5", 5 * 1024, 5.5 });
+		CHECK(table.find(5) == nullptr);
+		CHECK_THROWS_AS(table.at(-1), std::out_of_range);
+
+		// lookups don't lock
+		std::atomic<int> found{ 0 };
+		std::vector<std::thread> threads;
+		for(int t = 0; t < 4; ++t)
+		{
+			threads.emplace_back([&table, &found, t]
+			{
+				int local = 0;
+				for(int i = t; i < 2 * n; i += 4)
+					if(row_t const* row = table.find(i * 512); row && std::get<1>(*row) == i * 512)
+						++local;
+				found += local;
+			});
+		}
+		for(std::thread& thread : threads)
+			thread.join();
+		CHECK(found == n);
+	}
+	{
+		std::istringstream stream(data);
+		Reader reader(stream, ErrorThrow{}, readHeader);
+		const auto table = keyedTable<string_t, row_t>(reader, 0);
+		const string_view_t key = "name 9999";
+		REQUIRE(table.contains(key));
+		CHECK(std::get<1>(*table.find(key)) == 9999 * 1024);
+		CHECK(!table.contains(string_view_t("name")));
+	}
+}
+
+TEST_CASE("keyed table arena", "[uCSV][KeyedTable]")
+{
+	const string_view_t data = "a long key which doesn't fit into a small string,a long value which doesn't fit either,1\nb,c,2\n";
+	Reader reader(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+	using row_t = std::tuple<std::pmr::string, std::pmr::string, int>;
+	KeyedTable<std::pmr::string, row_t> table(reader, 0);
+	REQUIRE(table.size() == 2);
+	for(std::size_t i = 0; i < table.size(); ++i)
+	{
+		CHECK(table.keys()[i].get_allocator().resource() == table.resource());
+		CHECK(std::get<1>(table.rows()[i]).get_allocator().resource() == table.resource());
+	}
+
+	// moving the table keeps the arena
+	const KeyedTable<std::pmr::string, row_t> moved = std::move(table);
+	row_t const* row = moved.find(string_view_t("a long key which doesn't fit into a small string"));
+	REQUIRE(row);
+	CHECK(std::get<1>(*row) == "a long value which doesn't fit either");
+	CHECK(std::get<1>(*row).get_allocator().resource() == moved.resource());
+}
+
+TEST_CASE("keyed table growth", "[uCSV][KeyedTable]")
+{
+	// the arena only holds cells, hence rows without any don't allocate from it, nor from its upstream
+	struct CountingResource : std::pmr::memory_resource
+	{
+		std::size_t allocations = 0;
+
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			++allocations;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+		{
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+	string_t data;
+	for(int i = 0; i < 10000; ++i)
+		data += std::to_string(i) + ',' + std::to_string(i * 2) + '\n';
+
+	CountingResource upstream;
+	std::pmr::memory_resource* const previous = std::pmr::set_default_resource(&upstream);
+	{
+		Reader reader(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+		const KeyedTable<int, std::tuple<int, int>> table(reader, 0);
+		CHECK(table.size() == 10000);
+		CHECK(std::get<1>(table.at(9999)) == 19998);
+	}
+	std::pmr::set_default_resource(previous);
+	CHECK(upstream.allocations == 0);
+}
+
+TEST_CASE("keyed table errors", "[uCSV][KeyedTable]")
+{
+	const string_view_t duplicate = "1,a\n2,b\n1,c\n";
+	Reader reader(duplicate.begin(), duplicate.end(), ErrorThrow{}, ignoreHeader);
+	CHECK_THROWS_AS((keyedTable<int, std::vector<string_t>>(reader, 0)), std::runtime_error);
+
+	Reader missing(duplicate.begin(), duplicate.end(), ErrorThrow{}, ignoreHeader);
+	CHECK_THROWS_AS((keyedTable<int, std::vector<string_t>>(missing, 2)), std::out_of_range);
+
+	const KeyedTable<int, int> empty;
+	CHECK(empty.empty());
+	CHECK(empty.find(0) == nullptr);
+}
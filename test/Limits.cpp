@@ -0,0 +1,132 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct LimitRecorder : ErrorIgnore
+	{
+		std::vector<Limit> limits;
+		std::vector<unsigned int> columns;
+		void raiseLimitExceeded(Limit limit, unsigned int column, unsigned int row)
+		{
+			(void)row;
+			limits.push_back(limit);
+			columns.push_back(column);
+		}
+	};
+
+	template<typename ReaderT>
+	std::vector<string_t> firstCells(ReaderT& reader)
+	{
+		std::vector<string_t> cells;
+		while(!reader.done())
+			if(auto row = reader.fetch())
+				cells.emplace_back(row->cell(0));
+		return cells;
+	}
+}
+
+TEST_CASE("limits", "[uCSV][Limits]")
+{
+	{
+		// an unterminated quote doesn't swallow the rest of the input
+		string_t data = "a,b\n\"x,";
+		data.append(100000, 'y');
+		data += "\nc,d\ne,f\n";
+		std::istringstream stream(data);
+		Reader reader(stream, LimitRecorder{}, ignoreHeader);
+		reader.limits({ 64 });
+		CHECK(firstCells(reader) == std::vector<string_t>{ "a", "c", "e" });
+		CHECK(reader.errorHandler().limits == std::vector<Limit>{ Limit::cellBytes });
+		CHECK(reader.errorHandler().columns == std::vector<unsigned int>{ 0 });
+	}
+	{
+		const string_view_t data = "1,2,3\n1234,5678,9\n4,5,6\n";
+		Reader reader(data.begin(), data.end(), LimitRecorder{}, ignoreHeader);
+		Limits limits;
+		limits.rowBytes = 8;
+		reader.limits(limits);
+		CHECK(firstCells(reader) == std::vector<string_t>{ "1", "4" });
+		CHECK(reader.errorHandler().limits == std::vector<Limit>{ Limit::rowBytes });
+	}
+	{
+		const string_view_t data = "1,2\n3,\"4\n\",5,6\n7,8\n";
+		Reader reader(data.begin(), data.end(), LimitRecorder{}, ignoreHeader);
+		Limits limits;
+		limits.columns = 2;
+		reader.limits(limits);
+		CHECK(firstCells(reader) == std::vector<string_t>{ "1", "7" });
+		CHECK(reader.errorHandler().limits == std::vector<Limit>{ Limit::columns });
+		CHECK(reader.errorHandler().columns == std::vector<unsigned int>{ 2 });
+	}
+	{
+		// the unterminated quote in the excess cells doesn't swallow the rest of the input either
+		const string_view_t data = "a,b\n1,2,\"oops\n3,4\n5,6\n7,8\n";
+		Reader reader(data.begin(), data.end(), LimitRecorder{}, ignoreHeader);
+		Limits limits;
+		limits.columns = 2;
+		reader.limits(limits);
+		CHECK(firstCells(reader) == std::vector<string_t>{ "a", "3", "5", "7" });
+		CHECK(reader.errorHandler().limits == std::vector<Limit>{ Limit::columns });
+	}
+	{
+		const string_view_t data = "abcdef\nabc\n";
+		Reader reader(data.begin(), data.end(), ErrorFlags{}, ignoreHeader);
+		reader.limits({ 4 });
+		CHECK(firstCells(reader) == std::vector<string_t>{ "abc" });
+		CHECK(reader.errorHandler().limitExceeded());
+		CHECK(!reader.errorHandler().good());
+
+		Reader throwing(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+		throwing.limits({ 4 });
+		CHECK_THROWS_AS(throwing.fetch(), std::runtime_error);
+	}
+}
+
+TEST_CASE("streamed cells", "[uCSV][Limits]")
+{
+	string_t blob;
+	for(int i = 0; i < 1000; ++i)
+		blob += std::to_string(i);
+	const string_t data = "id,blob,tail\n1,\"" + blob + "\",x\n2,small,y\n";
+	Reader reader(data.begin(), data.end(), ErrorThrow{}, ignoreHeader);
+	reader.limits({ 100 });
+	string_t streamed;
+	std::size_t chunks = 0;
+	bool finished = false;
+	reader.streamCells([&](std::size_t row, std::size_t column, string_view_t chunk, bool last)
+	{
+		CHECK(row == 1);
+		CHECK(column == 1);
+		CHECK(chunk.size() <= 100);
+		CHECK(!finished);
+		streamed += chunk;
+		++chunks;
+		finished = last;
+	});
+
+	std::vector<std::vector<string_t>> rows;
+	while(!reader.done())
+	{
+		std::vector<string_t> row;
+		if(reader.fetch(row))
+			rows.push_back(std::move(row));
+	}
+	CHECK(finished);
+	CHECK(streamed == blob);
+	CHECK(chunks == blob.size() / 100 + 1);
+	CHECK(rows == std::vector<std::vector<string_t>>{ { "id", "blob", "tail" }, { "1", "", "x" }, { "2", "small", "y" } });
+}
@@ -0,0 +1,129 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/MultiFile.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	// fetchAll has to move the rows out, as this can't be copied
+	struct MoveOnly
+	{
+		string_t name;
+
+		MoveOnly() = default;
+		MoveOnly(MoveOnly&&) = default;
+		MoveOnly& operator=(MoveOnly&&) = default;
+	};
+	void deserialize(Deserializer& data, MoveOnly& target)
+	{
+		data.next();
+		target.name = data.next();
+	}
+}
+
+TEST_CASE("reset", "[uCSV][MultiFile]")
+{
+	using row_t = std::tuple<int, string_t>;
+	const string_view_t first = "id,name\n1,a\n2,b\n";
+	const string_view_t same = "id,name\n3,c\n";
+	const string_view_t other = "key,value,extra\n4,d,x\n";
+
+	Reader reader(first.begin(), first.end(), readHeader);
+	std::vector<row_t> rows;
+	reader.fetchAll(std::back_inserter(rows));
+	REQUIRE(rows.size() == 2);
+
+	reader.reset(same.begin(), same.end(), keepHeader);
+	row_t row;
+	REQUIRE(reader.fetch(row));
+	CHECK(row == row_t(3, "c"));
+	CHECK(reader.rows() == 2);
+	CHECK(reader.header(1) == "name");
+	CHECK(reader.done());
+
+	CHECK(reader.reset(same.begin(), same.end(), verifyHeader) == true);
+	CHECK(reader.fetch(row));
+	CHECK(reader.reset(other.begin(), other.end(), verifyHeader) == false);
+	CHECK(reader.columns() == 3);
+	CHECK(reader.header(0) == "key");
+
+	reader.reset(first.begin(), first.end(), ignoreHeader);
+	CHECK(reader.hasHeader() == false);
+	std::vector<string_t> cells;
+	REQUIRE(reader.fetch(cells));
+	CHECK(cells == std::vector<string_t>{ "id", "name" });
+
+	reader.reset(other.begin(), other.end(), readHeader);
+	CHECK(reader.columns() == 3);
+	CHECK(reader.header(2) == "extra");
+}
+
+TEST_CASE("multiple files", "[uCSV][MultiFile]")
+{
+	using row_t = std::tuple<int, string_t>;
+	const auto dir = std::filesystem::temp_directory_path();
+	std::vector<std::filesystem::path> paths;
+	const char* const contents[] = { "id,name\n1,a\n2,b\n", "id,name\n", "id,name\n3,c", "id,name\r\n4,\"d\"\r\n" };
+	for(std::size_t i = 0; i < std::size(contents); ++i)
+	{
+		paths.push_back(dir / ("uCSV_multifile_test_" + std::to_string(i) + ".csv"));
+		std::ofstream file(paths.back(), std::ofstream::binary | std::ofstream::trunc);
+		file << contents[i];
+	}
+
+	{
+		MultiFileReader reader(paths, verifyHeader);
+		std::vector<row_t> rows;
+		reader.fetchAll(std::back_inserter(rows));
+		CHECK(rows == std::vector<row_t>{ { 1, "a" }, { 2, "b" }, { 3, "c" }, { 4, "d" } });
+		CHECK(reader.file() == 3);
+		CHECK(reader.reader()->header(0) == "id");
+	}
+	{
+		MultiFileReader reader(paths, verifyHeader);
+		std::vector<MoveOnly> rows;
+		reader.fetchAll(std::back_inserter(rows));
+		REQUIRE(rows.size() == 4);
+		CHECK(rows[3].name == "d");
+	}
+	{
+		MultiFileReader reader(paths, ErrorFlags{}, ignoreHeader);
+		std::size_t count = 0;
+		for(; !reader.done(); ++count)
+			CHECK(reader.fetch().has_value());
+		CHECK(count == 8);
+	}
+
+	{
+		std::ofstream file(paths[2], std::ofstream::binary | std::ofstream::trunc);
+		file << "id,other\n3,c\n";
+	}
+	{
+		MultiFileReader reader(paths, keepHeader);
+		std::vector<row_t> rows;
+		reader.fetchAll(std::back_inserter(rows));
+		CHECK(rows.size() == 4);
+	}
+	{
+		MultiFileReader reader(paths, verifyHeader);
+		std::vector<row_t> rows;
+		CHECK_THROWS_AS(reader.fetchAll(std::back_inserter(rows)), std::runtime_error);
+		CHECK(rows.size() == 2);
+	}
+	for(auto const& path : paths)
+		std::filesystem::remove(path);
+	CHECK_THROWS_AS(MultiFileReader(paths, readHeader).done(), std::runtime_error);
+}
@@ -0,0 +1,90 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Pipeline.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+TEST_CASE("pipeline", "[uCSV][Pipeline]")
+{
+	constexpr int n = 20000;
+	std::string data = "id,name,value\n";
+	for(int i = 0; i < n; ++i)
+		data += std::to_string(i) + ",\"name " + std::to_string(i) + "\"," + std::to_string(i) + ".5\n";
+
+	using row_t = std::tuple<int, string_t, double>;
+	for(const std::size_t threads : { 1, 3 })
+	{
+		std::istringstream stream(data);
+		Reader reader(stream, ErrorThrow{}, readHeader);
+		PipelineOptions options;
+		options.threads = threads;
+		options.batchRows = 100;
+		auto rows = pipeline<row_t>(reader, options);
+
+		std::vector<row_t> result;
+		rows.fetchAll(std::back_inserter(result));
+		REQUIRE(result.size() == n);
+		bool good = true;
+		for(int i = 0; i < n; ++i)
+			good &= result[i] == row_t{ i, "name " + std::to_string(i), i + 0.5 };
+		CHECK(good);
+	}
+}
+
+TEST_CASE("pipeline errors", "[uCSV][Pipeline]")
+{
+	constexpr char_t data[] = "A,B\n1,2\nx,3\n4\n5,6\n";
+	std::istringstream stream(data);
+	Reader reader(stream, ErrorFlags{}, readHeader);
+	PipelineOptions options;
+	options.batchRows = 1;
+	auto rows = pipeline<std::vector<int>>(reader, options);
+
+	std::vector<int> row;
+	REQUIRE(rows.fetch(row) == true);
+	CHECK(row == std::vector<int>{ 1, 2 });
+	CHECK_THROWS_AS(rows.fetch(row), std::runtime_error);
+	REQUIRE(rows.fetch(row) == true);
+	CHECK(row == std::vector<int>{ 5, 6 });
+	CHECK(rows.fetch(row) == false);
+	CHECK(reader.errorHandler().incorrectColumns() == true);
+}
+
+TEST_CASE("pipeline scan errors", "[uCSV][Pipeline]")
+{
+	constexpr char_t data[] = "1,2\n3\n";
+	std::istringstream stream(data);
+	Reader reader(stream, ErrorThrow{}, ignoreHeader);
+	auto rows = pipeline<std::vector<string_t>>(reader);
+
+	std::vector<string_t> row;
+	REQUIRE(rows.fetch(row) == true);
+	CHECK_THROWS_AS(rows.fetch(row), std::runtime_error);
+	CHECK(rows.fetch(row) == false);
+}
+
+TEST_CASE("pipeline early destruction", "[uCSV][Pipeline]")
+{
+	std::string data;
+	for(int i = 0; i < 10000; ++i)
+		data += "a,b,c\n";
+	std::istringstream stream(data);
+	Reader reader(stream, ErrorThrow{}, ignoreHeader);
+	PipelineOptions options;
+	options.batchRows = 10;
+	options.maxBatches = 2;
+	auto rows = pipeline<std::vector<string_t>>(reader, options);
+	std::vector<string_t> row;
+	CHECK(rows.fetch(row) == true);
+}
@@ -0,0 +1,108 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Profile.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("column profiler", "[uCSV][Profile]")
+{
+	constexpr int n = 100000;
+	string_t data = "id,value,name\n";
+	for(int i = 0; i < n; ++i)
+		data += std::to_string(i) + ',' + (i % 10 == 0 ? string_t() : std::to_string(i % 1000 - 500) + ".5") + ",\"n" + std::to_string(i % 37) + "\"\n";
+	data += "x,1e3,\n";
+
+	std::istringstream stream(data);
+	Reader reader(stream, ErrorThrow{}, readHeader);
+	ColumnProfiler profiler;
+	profiler.attach(reader);
+	reader.discard(10);
+	std::vector<string_t> row;
+	while(!reader.done())
+		reader.fetch(row);
+
+	CHECK(profiler.rows() == n + 1);
+	const std::vector<ColumnProfile> profiles = profiler.profiles();
+	REQUIRE(profiles.size() == 3);
+
+	ColumnProfile const& id = profiles[0];
+	CHECK(id.cells == n + 1);
+	CHECK(id.empty == 0);
+	CHECK(id.numeric == n);
+	CHECK(id.min == 0);
+	CHECK(id.max == n - 1);
+	CHECK(id.minText == "0");
+	CHECK(id.maxText == "x");
+	CHECK(id.maxBytes == 5);
+	CHECK(std::abs(id.distinct - (n + 1)) < 0.05 * n);
+
+	ColumnProfile const& value = profiles[1];
+	CHECK(value.empty == n / 10);
+	CHECK(value.numeric == n - n / 10 + 1);
+	CHECK(value.min == -499.5);
+	CHECK(value.max == 1000);
+	CHECK(std::abs(value.distinct - 901) < 0.05 * 901);
+
+	ColumnProfile const& name = profiles[2];
+	CHECK(name.empty == 1);
+	CHECK(name.numeric == 0);
+	CHECK(std::isnan(name.min));
+	CHECK(name.minText == "n0");
+	CHECK(name.maxText == "n9");
+	CHECK(std::round(name.distinct) == 37);
+
+	// detached, it no longer sees rows
+	ColumnProfiler::detach(reader);
+	std::istringstream more("id,value,name\n1,2,3\n");
+	reader.reset(std::istreambuf_iterator<char_t>(more), std::istreambuf_iterator<char_t>(), keepHeader);
+	CHECK(reader.fetch(row));
+	CHECK(profiler.rows() == n + 1);
+}
+
+TEST_CASE("column profiler headers", "[uCSV][Profile]")
+{
+	// the headers read by the constructor and by reset aren't profiled as rows
+	const string_view_t first = "id,name\n1,b\n";
+	const string_view_t second = "id,name\n2,c\n";
+	Reader reader(first.begin(), first.end(), ErrorThrow{}, readHeader);
+	ColumnProfiler profiler;
+	profiler.attach(reader);
+	CHECK(reader.discard());
+	reader.reset(second.begin(), second.end(), readHeader);
+	CHECK(reader.discard());
+	CHECK(reader.reset(first.begin(), first.end(), verifyHeader));
+	CHECK(reader.discard());
+
+	CHECK(profiler.rows() == 3);
+	const std::vector<ColumnProfile> profiles = profiler.profiles();
+	REQUIRE(profiles.size() == 2);
+	CHECK(profiles[0].cells == 3);
+	CHECK(profiles[0].numeric == 3);
+	CHECK(profiles[1].minText == "b");
+	CHECK(profiles[1].maxText == "c");
+	CHECK(std::round(profiles[1].distinct) == 2);
+}
+
+TEST_CASE("hyperloglog", "[uCSV][Profile]")
+{
+	HyperLogLog lhs(14);
+	HyperLogLog rhs(14);
+	for(int i = 0; i < 200000; ++i)
+		(i % 2 ? lhs : rhs).add(uCSV::hash(std::to_string(i % 150000)));
+	CHECK(std::abs(lhs.estimate() - 75000) < 0.03 * 75000);
+	lhs.merge(rhs);
+	CHECK(std::abs(lhs.estimate() - 150000) < 0.03 * 150000);
+	CHECK_THROWS_AS(lhs.merge(HyperLogLog(10)), std::invalid_argument);
+	CHECK(HyperLogLog().estimate() == 0);
+}
@@ -0,0 +1,113 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <deque>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	// counts how rows reach their destination
+	struct Tracked
+	{
+		string_t name;
+		int value = 0;
+		int copies = 0;
+
+		Tracked() = default;
+		Tracked(Tracked const& other)
+			: name(other.name), value(other.value), copies(other.copies + 1)
+		{
+		}
+		Tracked(Tracked&&) = default;
+		Tracked& operator=(Tracked const& other)
+		{
+			name = other.name;
+			value = other.value;
+			copies = other.copies + 1;
+			return *this;
+		}
+		Tracked& operator=(Tracked&&) = default;
+	};
+	void deserialize(Deserializer& data, Tracked& target)
+	{
+		deserializeMany(data, target.name, target.value);
+	}
+
+	const string_view_t data = "name,value\na,1\nb,2\nc\nd,4\n";
+}
+
+TEST_CASE("fetch moves rows", "[uCSV][Ranges]")
+{
+	{
+		// fetchAll stops at the first bad row
+		Reader reader(data.begin(), data.end(), ErrorIgnore{}, readHeader);
+		std::vector<Tracked> rows;
+		reader.fetchAll(std::back_inserter(rows));
+		REQUIRE(rows.size() == 2);
+		CHECK(rows[1].name == "b");
+		for(Tracked const& row : rows)
+			CHECK(row.copies == 0);
+	}
+	{
+		Reader reader(data.begin(), data.end(), ErrorIgnore{}, readHeader);
+		std::deque<Tracked> rows;
+		CHECK(reader.emplaceAll(rows) == 3);
+		REQUIRE(rows.size() == 3);
+		CHECK(rows[1].value == 2);
+		for(Tracked const& row : rows)
+			CHECK(row.copies == 0);
+	}
+	{
+		// a row that fails to deserialize isn't left behind
+		const string_view_t bad = "1\nx\n";
+		Reader reader(bad.begin(), bad.end(), ErrorThrow{}, ignoreHeader);
+		std::vector<std::tuple<int, int>> rows;
+		CHECK_THROWS(reader.emplaceAll(rows));
+		CHECK(rows.empty());
+	}
+}
+
+TEST_CASE("row range", "[uCSV][Ranges]")
+{
+	std::istringstream stream{ string_t(data) };
+	Reader reader(stream, ErrorIgnore{}, readHeader);
+	std::vector<string_t> names;
+	int sum = 0;
+	for(Tracked& row : reader.rows<Tracked>())
+	{
+		names.push_back(std::move(row.name));
+		sum += row.value;
+	}
+	CHECK(names == std::vector<string_t>{ "a", "b", "d" });
+	CHECK(sum == 7);
+
+	const string_view_t empty = "a,b\n";
+	Reader none(empty.begin(), empty.end(), ErrorIgnore{}, readHeader);
+	auto range = none.rows<std::vector<string_t>>();
+	CHECK(range.begin() == range.end());
+
+#if defined(__cpp_lib_ranges)
+	static_assert(std::ranges::input_range<RowRange<decltype(reader), Tracked>>);
+	static_assert(std::ranges::view<RowRange<decltype(reader), Tracked>>);
+	Reader piped(data.begin(), data.end(), ErrorIgnore{}, readHeader);
+	std::vector<int> values;
+	for(const int value : piped.rows<std::tuple<string_t, int>>()
+		| std::views::transform([](auto const& row) { return std::get<1>(row); })
+		| std::views::filter([](int value) { return value % 2 == 0; }))
+		values.push_back(value);
+	CHECK(values == std::vector<int>{ 2, 4 });
+#endif
+}
@@ -0,0 +1,135 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Sample.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <set>
+#include <string>
+
+namespace
+{
+	string_t text(std::size_t id)
+	{
+		switch(id % 4)
+		{
+		case 0:
+			return "plain " + std::to_string(id);
+		case 1:
+			return "a, \"quoted\"\ncell\nspanning lines";
+		case 2:
+			return "\n\"\",\n";
+		default:
+			return {};
+		}
+	}
+}
+
+TEST_CASE("sample", "[uCSV][Sample]")
+{
+	string_t data = "id,text\n";
+	constexpr std::size_t total = 20000;
+	for(std::size_t id = 0; id < total; ++id)
+		data += std::to_string(id) + ',' + escapeToStr(text(id)) + (id % 2 ? "\r\n" : "\n");
+
+	const string_view_t view = data;
+	Reader reader(view.begin(), view.end(), ErrorThrow{}, readHeader);
+	std::mt19937 rng(42);
+	std::set<int> ids;
+	int previous = 0;
+	bool ordered = true;
+	const SampleStatistics statistics = sample(reader, 500, rng, [&](Deserializer& row)
+	{
+		int id;
+		string_t cell;
+		deserializeMany(row, id, cell);
+		CHECK(cell == text(static_cast<std::size_t>(id)));
+		ordered = ordered && (ids.empty() || id > previous);
+		previous = id;
+		ids.insert(id);
+	});
+	CHECK(statistics.rows == 500);
+	CHECK(ids.size() == 500);
+	CHECK(ordered);
+	CHECK(!statistics.fullScan);
+	CHECK(statistics.attempts < total / 4);
+	CHECK(reader.done());
+}
+
+TEST_CASE("sample length bias", "[uCSV][Sample]")
+{
+	// every other record is 50 times as long
+	string_t data;
+	constexpr std::size_t total = 20000;
+	for(std::size_t id = 0; id < total; ++id)
+		data += std::to_string(id % 10) + ',' + (id % 2 ? string_t(200, 'x') : "x") + '\n';
+
+	const string_view_t view = data;
+	Reader reader(view.begin(), view.end(), ErrorThrow{}, ignoreHeader);
+	std::mt19937 rng(7);
+	std::size_t rows = 0;
+	std::size_t longRows = 0;
+	const SampleStatistics statistics = sample(reader, 2000, rng, [&](Deserializer& row)
+	{
+		++rows;
+		longRows += row.cell(1).size() > 1;
+	});
+	CHECK(!statistics.fullScan);
+	CHECK(rows == 2000);
+	CHECK(longRows > 800);
+	CHECK(longRows < 1200);
+	CHECK(statistics.rejected > 0);
+}
+
+TEST_CASE("sample late shortest record", "[uCSV][Sample]")
+{
+	// a short record is found only after hundreds of long ones have been kept against a longer shortest record
+	string_t data;
+	constexpr std::size_t total = 20000;
+	for(std::size_t id = 0; id < total; ++id)
+		data += std::to_string(id % 10) + ',' + (id % 5 ? string_t(400, 'x') : "x") + '\n';
+
+	const string_view_t view = data;
+	Reader reader(view.begin(), view.end(), ErrorThrow{}, ignoreHeader);
+	std::mt19937 rng(3);
+	SampleOptions options;
+	options.window = 2048;
+	std::size_t rows = 0;
+	std::size_t shortRows = 0;
+	const SampleStatistics statistics = sample(reader, 2000, rng, [&](Deserializer& row)
+	{
+		++rows;
+		shortRows += row.cell(1).size() == 1;
+	}, options);
+	CHECK(!statistics.fullScan);
+	CHECK(rows == 2000);
+	CHECK(shortRows > 350);
+	CHECK(shortRows < 450);
+}
+
+TEST_CASE("sample fallback", "[uCSV][Sample]")
+{
+	const string_view_t data = "a,b\n1,2\n3,\"4\n\"\n5,6\n";
+	Reader reader(data.begin(), data.end(), ErrorThrow{}, readHeader);
+	std::mt19937 rng(1);
+	std::set<int> firsts;
+	const SampleStatistics statistics = sample(reader, 10, rng, [&](Deserializer& row)
+	{
+		int first;
+		deserialize(row, first);
+		firsts.insert(first);
+	});
+	CHECK(statistics.fullScan);
+	CHECK(statistics.rows == 3);
+	CHECK(firsts == std::set<int>{ 1, 3, 5 });
+
+	Reader empty(data.begin(), data.end(), ErrorThrow{}, readHeader);
+	CHECK(sample(empty, 0, rng, [](Deserializer&) {}).rows == 0);
+}
@@ -0,0 +1,130 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Sidecar.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+TEST_CASE("sidecar", "[uCSV][Sidecar]")
+{
+	const auto dir = std::filesystem::temp_directory_path();
+	const auto source = dir / "uCSV_sidecar_test.csv";
+	const auto sidecar = dir / "uCSV_sidecar_test.csv.sidecar";
+	std::filesystem::remove(sidecar);
+	{
+		std::ofstream file(source, std::ofstream::binary | std::ofstream::trunc);
+		file << "id,name,weight\n1,alpha,0.5\n2,\"be,ta\",1.25\n-3,,2\nx,gamma,3\n";
+	}
+
+	const SidecarSchema schema =
+	{
+		{ 0, ColumnType::int64 },
+		{ 1, ColumnType::string },
+		{ 2, ColumnType::float64, "w" },
+	};
+
+	CHECK(Sidecar::open(sidecar, source).has_value() == false);
+	{
+		std::ifstream file(source, std::ifstream::binary);
+		Reader reader(file, ErrorFlags{}, readHeader);
+		CHECK(writeSidecar(reader, schema, source, sidecar) == 4);
+		CHECK(reader.errorHandler().badCell() == true);
+	}
+
+	std::optional<Sidecar> loaded = Sidecar::open(sidecar, source, true);
+	REQUIRE(loaded.has_value());
+	REQUIRE(loaded->rows() == 4);
+	REQUIRE(loaded->columns() == 3);
+	CHECK(loaded->name(0) == "id");
+	CHECK(loaded->name(1) == "name");
+	CHECK(loaded->name(2) == "w");
+	CHECK(loaded->type(1) == ColumnType::string);
+
+	std::int64_t const* ids = loaded->int64s(0);
+	CHECK(ids[0] == 1);
+	CHECK(ids[1] == 2);
+	CHECK(ids[2] == -3);
+	CHECK(ids[3] == 0);
+	CHECK(loaded->string(1, 0) == "alpha");
+	CHECK(loaded->string(1, 1) == "be,ta");
+	CHECK(loaded->string(1, 2) == "");
+	CHECK(loaded->string(1, 3) == "gamma");
+	double const* weights = loaded->float64s(2);
+	CHECK(weights[0] == 0.5);
+	CHECK(weights[1] == 1.25);
+	CHECK(weights[3] == 3);
+	CHECK_THROWS_AS(loaded->float64s(0), std::invalid_argument);
+
+	{
+		std::ofstream file(source, std::ofstream::binary | std::ofstream::app);
+		file << "4,delta,4\n";
+	}
+	CHECK(Sidecar::open(sidecar, source).has_value() == false);
+	CHECK(Sidecar::open(sidecar).has_value() == true);
+
+	// corrupt sidecars are rejected rather than trusted halfway
+	string_t bytes;
+	{
+		std::ifstream file(sidecar, std::ifstream::binary);
+		bytes.assign(std::istreambuf_iterator<char_t>(file), std::istreambuf_iterator<char_t>());
+	}
+	const auto patched = [&](auto patch)
+	{
+		string_t copy = bytes;
+		patch(copy.data());
+		{
+			std::ofstream file(sidecar, std::ofstream::binary | std::ofstream::trunc);
+			file.write(copy.data(), static_cast<std::streamsize>(copy.size()));
+		}
+		return Sidecar::open(sidecar);
+	};
+	const auto corrupted = [&](auto patch)
+	{
+		return !patched(patch).has_value();
+	};
+	CHECK(corrupted([](char_t*) {}) == false);
+	CHECK(corrupted([](char_t* data)
+	{
+		Detail::SidecarFileHeader header;
+		std::memcpy(&header, data, sizeof(header));
+		header.rows = std::uint64_t(1) << 61;
+		std::memcpy(data, &header, sizeof(header));
+	}));
+	const auto offset = [](std::uint64_t row, std::uint64_t value)
+	{
+		return [row, value](char_t* data)
+		{
+			Detail::SidecarColumnEntry entry;
+			std::memcpy(&entry, data + sizeof(Detail::SidecarFileHeader) + sizeof(entry), sizeof(entry));
+			std::memcpy(data + entry.dataOffset + row * sizeof(std::uint64_t), &value, sizeof(value));
+		};
+	};
+	CHECK(corrupted(offset(0, 1)));
+	CHECK(corrupted(offset(4, 1000)));
+	// the inner offsets are only checked once they're used
+	{
+		const std::optional<Sidecar> inner = patched(offset(2, 1));
+		REQUIRE(inner.has_value());
+		CHECK(inner->string(1, 0) == "alpha");
+		CHECK_THROWS_AS(inner->string(1, 1), std::runtime_error);
+	}
+	{
+		const std::optional<Sidecar> inner = patched(offset(2, 1000));
+		REQUIRE(inner.has_value());
+		CHECK_THROWS_AS(inner->string(1, 2), std::runtime_error);
+	}
+
+	std::filesystem::remove(source);
+	std::filesystem::remove(sidecar);
+}
@@ -0,0 +1,111 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Sniff.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("sniff", "[uCSV][Sniff]")
+{
+	{
+		const SniffResult result = sniff("id;price;when;name\r\n1;2.5;2020-01-02;\"a;b\"\r\n2;3;2020-01-03T04:05:06Z;c\r\n");
+		CHECK(result.delimiter == ';');
+		CHECK(result.lineEnding == LineEnding::crlf);
+		CHECK(result.header);
+		CHECK(result.quotesSeen);
+		CHECK(result.quoting);
+		CHECK(result.complete);
+		CHECK(result.records == 3);
+		CHECK(result.types == std::vector<CellType>{ CellType::integer, CellType::floating, CellType::timestamp, CellType::text });
+		CHECK(result.names == std::vector<string_t>{ "id", "price", "when", "name" });
+	}
+	{
+		const SniffResult result = sniff("1\t2\tx\n3\t4.5\ty\n5\t\t7a\n");
+		CHECK(result.delimiter == '\t');
+		CHECK(!result.header);
+		CHECK(!result.quoting);
+		CHECK(result.types == std::vector<CellType>{ CellType::integer, CellType::floating, CellType::text });
+	}
+	{
+		// numbers are recognized regardless of their length, but only as a whole
+		const string_t digits(80, '1');
+		const SniffResult result = sniff("1,2\n" + digits + ".5,1.5abc\n");
+		CHECK(result.types == std::vector<CellType>{ CellType::floating, CellType::text });
+	}
+	{
+		// text only: a header has unique names which don't reappear
+		CHECK(sniff("name|city\nann|rome\nbob|oslo\n").header);
+		CHECK(!sniff("ann|rome\nbob|rome\nann|oslo\n").header);
+	}
+	{
+		// the incomplete last record is ignored, and quoting can't be ruled out
+		string_t data = "a,b\n1,2\n";
+		for(int i = 0; i < 100; ++i)
+			data += "3,4\n";
+		SniffOptions options;
+		options.sampleBytes = 30;
+		const SniffResult result = sniff(data, options);
+		CHECK(!result.complete);
+		CHECK(result.records == 7);
+		CHECK(result.header);
+		CHECK(result.quoting);
+		options.trustSample = true;
+		CHECK(!sniff(data, options).quoting);
+	}
+}
+
+TEST_CASE("sniffed reader", "[uCSV][Sniff]")
+{
+	const string_view_t data = "a|b\n1|x,y\n2|\"z\"\n";
+	const SniffResult result = sniff(data);
+	REQUIRE(result.delimiter == '|');
+	REQUIRE(result.header);
+	const std::vector<string_t> cells = withSniffedReader(result, data.begin(), data.end(), [](auto& reader)
+	{
+		std::vector<string_t> cells;
+		CHECK(reader.header(1) == "b");
+		while(!reader.done())
+			if(auto row = reader.fetch())
+				cells.emplace_back(row->cell(1));
+		return cells;
+	}, ErrorThrow{});
+	CHECK(cells == std::vector<string_t>{ "x,y", "z" });
+
+	// without quotes in the input, they are ordinary characters
+	const string_view_t unquoted = "a,b\n1,2\n";
+	const SniffResult plain = sniff(unquoted);
+	CHECK(!plain.quoting);
+	withSniffedReader(plain, unquoted.begin(), unquoted.end(), [](auto& reader)
+	{
+		using ReaderType = std::decay_t<decltype(reader)>;
+		CHECK(ReaderType::DialectType::quote == '\0');
+	});
+
+	// the byte order mark isn't part of the first name, neither in the sniffed header nor in the one of the reader
+	const string_view_t bom = "\xEF\xBB\xBFid;name\n1;x\n";
+	const SniffResult marked = sniff(bom);
+	CHECK(marked.bom);
+	CHECK(!plain.bom);
+	REQUIRE(marked.header);
+	CHECK(marked.names == std::vector<string_t>{ "id", "name" });
+	withSniffedReader(marked, bom.begin(), bom.end(), [&marked](auto& reader)
+	{
+		CHECK(reader.header(0) == marked.names[0]);
+		auto row = reader.fetch();
+		REQUIRE(row);
+		CHECK(row->name() == "id");
+		CHECK(row->cell(0) == "1");
+	}, ErrorThrow{});
+
+	SniffResult other = plain;
+	other.delimiter = ':';
+	CHECK_THROWS_AS(withSniffedReader(other, unquoted.begin(), unquoted.end(), [](auto&) {}), std::runtime_error);
+}
@@ -0,0 +1,121 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Sort.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+TEST_CASE("external sort", "[uCSV][Sort]")
+{
+	string_t data = "key,id,text\r\n";
+	constexpr int n = 6000;
+	std::vector<std::tuple<int, int, string_t>> expected;
+	for(int i = 0; i < n; ++i)
+	{
+		const int key = (i * 7919) % 101 - 50;
+		const string_t text = i % 3 == 0 ? "multi\nline, \"quoted\"" : "text " + std::to_string(i);
+		data += std::to_string(key) + ',' + std::to_string(i) + ',' + escapeToStr(text) + (i % 2 ? "\r\n" : "\n");
+		expected.emplace_back(key, i, text);
+	}
+	// stability keeps the ids in ascending order within equal keys
+	std::stable_sort(expected.begin(), expected.end(), [](auto const& lhs, auto const& rhs) { return std::get<0>(lhs) < std::get<0>(rhs); });
+
+	for(const std::size_t fanIn : { 2, 64 })
+	{
+		std::istringstream input(data);
+		std::ostringstream output;
+		SortOptions options;
+		options.memory = 1;
+		options.threads = 3;
+		options.fanIn = fanIn;
+		const SortStatistics statistics = externalSort(input, output, { { 0, ColumnType::int64 } }, readHeader, options);
+		CHECK(statistics.rows == n);
+		CHECK(statistics.runs > 2);
+		CHECK((statistics.mergePasses > 0) == (fanIn == 2));
+
+		const string_t sorted = output.str();
+		CHECK(sorted.compare(0, 12, "key,id,text\n") == 0);
+		CHECK(sorted.find(",\"multi\nline, \"\"quoted\"\"\"\n") != string_t::npos);
+		std::istringstream stream(sorted);
+		Reader reader(stream, ErrorThrow{}, readHeader);
+		std::vector<std::tuple<int, int, string_t>> rows;
+		reader.fetchAll(std::back_inserter(rows));
+		CHECK(rows == expected);
+	}
+}
+
+TEST_CASE("external sort budget", "[uCSV][Sort]")
+{
+	// the raw bytes fit into two chunks, but sorting the short records takes much more memory than that
+	string_t data;
+	constexpr int n = 20000;
+	for(int i = 0; i < n; ++i)
+		data += std::to_string((i * 7919) % n) + (i + 1 < n ? ",x\n" : ",x");
+	std::istringstream input(data);
+	std::ostringstream output;
+	SortOptions options;
+	options.memory = 1;
+	options.threads = 1;
+	const SortStatistics statistics = externalSort(input, output, { { 0 } }, ignoreHeader, options);
+	CHECK(statistics.rows == n);
+	CHECK(statistics.runs > 2 * data.size() / (1 << 16));
+
+	std::istringstream stream(output.str());
+	Reader reader(stream, ErrorThrow{}, ignoreHeader);
+	std::vector<std::tuple<string_t, string_t>> rows;
+	reader.fetchAll(std::back_inserter(rows));
+	REQUIRE(rows.size() == n);
+	CHECK(std::is_sorted(rows.begin(), rows.end()));
+}
+
+TEST_CASE("external sort keys", "[uCSV][Sort]")
+{
+	const string_t data = "b,1.5\na,x\n\"c\",2\nb,\na,-1e3\nc,0.5";
+	std::istringstream input(data);
+	std::ostringstream output;
+	const SortStatistics statistics = externalSort(input, output, { { 0, ColumnType::string, true }, { 1, ColumnType::float64 } }, ignoreHeader);
+	CHECK(statistics.rows == 6);
+	CHECK(statistics.runs == 0);
+	CHECK(output.str() == "c,0.5\n\"c\",2\nb,\nb,1.5\na,x\na,-1e3\n");
+
+	// nulls come first regardless of the direction
+	std::istringstream nulls("1,a\nx,b\n3,c\n,d\n2,e\n");
+	std::ostringstream descending;
+	CHECK(externalSort(nulls, descending, { { 0, ColumnType::float64, true } }, ignoreHeader).rows == 5);
+	CHECK(descending.str() == "x,b\n,d\n3,c\n2,e\n1,a\n");
+
+	std::istringstream empty;
+	std::ostringstream nothing;
+	CHECK(externalSort(empty, nothing, { { 0 } }, readHeader).rows == 0);
+	CHECK(nothing.str().empty());
+
+	std::istringstream missing("a,b\n");
+	std::ostringstream ignored;
+	CHECK_THROWS_AS(externalSort(missing, ignored, { { 2 } }, ignoreHeader), std::out_of_range);
+}
+
+TEST_CASE("external sort files", "[uCSV][Sort]")
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "ucsv-sort-test";
+	std::filesystem::create_directories(directory);
+	{
+		std::ofstream file(directory / "in.csv", std::ofstream::binary);
+		file << "name;value\nb;2\na;1\n";
+	}
+	externalSort<Delimiter<';'>>(directory / "in.csv", directory / "out.csv", { { 0 } }, readHeader);
+	std::ifstream file(directory / "out.csv", std::ifstream::binary);
+	const string_t sorted{ std::istreambuf_iterator<char_t>(file), std::istreambuf_iterator<char_t>() };
+	CHECK(sorted == "name;value\na;1\nb;2\n");
+	file.close();
+	std::filesystem::remove_all(directory);
+}
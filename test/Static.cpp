@@ -0,0 +1,80 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+#include <uCSV/Static.hpp>
+using namespace uCSV;
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	constexpr string_view_t units = "name,factor,exponent\nmilli,0.001,-3\n\"kilo\",1e3,3\r\nmega,1000000,6";
+	using unit_t = std::tuple<string_view_t, double, int>;
+	constexpr auto unitTable = staticTable<unit_t, staticRows(units, readHeader)>(units, readHeader);
+	constexpr auto unitHeader = staticHeader<staticColumns(units)>(units);
+
+	static_assert(unitTable.size() == 3);
+	static_assert(std::get<0>(unitTable[1]) == "kilo");
+	static_assert(std::get<1>(unitTable[1]) == 1000.0);
+	static_assert(std::get<2>(unitTable[0]) == -3);
+	static_assert(unitHeader[2] == "exponent");
+
+	constexpr string_view_t pairs = "1;-2;3\n4;5;6\n";
+	constexpr auto pairTable = staticTable<std::pair<unsigned, std::array<long, 2>>, staticRows<Delimiter<';'>>(pairs, ignoreHeader), Delimiter<';'>>(pairs, ignoreHeader);
+	static_assert(pairTable[0].second[0] == -2);
+	static_assert(pairTable[1].first == 4u);
+}
+
+TEST_CASE("static tables", "[uCSV][Static]")
+{
+	CHECK(std::get<1>(unitTable[0]) == std::strtod("0.001", nullptr));
+	CHECK(std::get<1>(unitTable[2]) == 1e6);
+	CHECK(std::get<0>(unitTable[2]) == "mega");
+
+	CHECK(staticRows("", ignoreHeader) == 0);
+	CHECK(staticRows("a\nb\n", ignoreHeader) == 2);
+	CHECK(staticColumns("a,b,\n1,2,3") == 3);
+
+	// exactly representable values are exact, the others are within an ulp of strtod
+	const char* const exact[] = { "+.5", "6.", "-1024.125", "0.25e2", "0", "1e22" };
+	for(const char* text : exact)
+	{
+		double parsed = -1;
+		Detail::staticFloating(string_view_t(text), parsed);
+		CHECK(parsed == std::strtod(text, nullptr));
+	}
+	const char* const inexact[] = { "0.1", "-2.5e-3", "123456.789", "1.7976931348623157e308", "2.2250738585072014e-308", "4.9e-324", "1.2345678901234567890123e-300", "9.87e250" };
+	for(const char* text : inexact)
+	{
+		double parsed = 0;
+		Detail::staticFloating(string_view_t(text), parsed);
+		const double expected = std::strtod(text, nullptr);
+		CAPTURE(text);
+		CHECK(parsed >= std::nextafter(expected, -HUGE_VAL));
+		CHECK(parsed <= std::nextafter(expected, HUGE_VAL));
+		CHECK(std::isfinite(parsed));
+	}
+	double overflow = 0;
+	Detail::staticFloating("1e400", overflow);
+	CHECK(overflow == HUGE_VAL);
+	double underflow = 1;
+	Detail::staticFloating("-1e-400", underflow);
+	CHECK(underflow == 0);
+
+	using row_t = std::pair<int, int>;
+	CHECK_THROWS_AS((staticTable<row_t, 1>("1,2,3", ignoreHeader)), std::runtime_error);
+	CHECK_THROWS_AS((staticTable<row_t, 2>("1,2\n3", ignoreHeader)), std::out_of_range);
+	CHECK_THROWS_AS((staticTable<row_t, 2>("1,2\n\n3,4", ignoreHeader)), std::runtime_error);
+	CHECK_THROWS_AS((staticTable<row_t, 1>("1,x", ignoreHeader)), std::runtime_error);
+	CHECK_THROWS_AS((staticTable<row_t, 1>("1,99999999999", ignoreHeader)), std::out_of_range);
+	CHECK_THROWS_AS((staticTable<row_t, 2>("1,2", ignoreHeader)), std::length_error);
+	CHECK_THROWS_AS((staticTable<std::tuple<string_view_t>, 1>("\"a\"\"b\"", ignoreHeader)), std::runtime_error);
+	CHECK_THROWS_AS((staticTable<std::tuple<string_view_t>, 1>("\"ab", ignoreHeader)), std::runtime_error);
+}
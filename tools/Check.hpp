@@ -0,0 +1,311 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+// the validation of ucsv-check, apart from its command line and its output
+
+#ifndef UCSV_TOOLS_CHECK_HPP_INCLUDED
+#define UCSV_TOOLS_CHECK_HPP_INCLUDED
+
+#include <uCSV.hpp>
+#include <uCSV/Pipeline.hpp>
+#include <uCSV/Sniff.hpp>
+#include <uCSV/Sort.hpp>
+
+#include <deque>
+#include <future>
+#include <istream>
+
+namespace uCSV::Check
+{
+	struct Options
+	{
+		char_t delimiter = '\0'; // sniffed if '\0'
+		int header = -1; // sniffed if negative
+		bool utf8 = true;
+		std::size_t threads = 0;
+		std::size_t chunkBytes = std::size_t(8) << 20;
+		std::size_t maxRecordBytes = std::size_t(64) << 20;
+		std::size_t maxErrors = 20;
+		bool statistics = true;
+	};
+
+	enum class Problem
+	{
+		columns,
+		quoting,
+		unexpectedEnd,
+		encoding,
+		oversized,
+	};
+	inline constexpr std::size_t problems = 5;
+	inline constexpr char const* problemNames[problems] = { "column count", "quoting", "unexpected end", "encoding", "oversized record" };
+
+	struct Error
+	{
+		Problem problem;
+		std::uint64_t record; // 1-based, the header included
+		std::uint64_t offset; // of the record in bytes
+		std::size_t column = 0;
+		std::size_t columns = 0;
+	};
+
+	// a file which can't be validated at all, as opposed to one which can't be read
+	struct MalformedFile : std::runtime_error
+	{
+		using std::runtime_error::runtime_error;
+	};
+
+	struct ColumnStatistics
+	{
+		std::uint64_t empty = 0;
+		std::uint64_t types[4] = {}; // indexed by CellType
+		std::size_t maxBytes = 0;
+
+		void merge(ColumnStatistics const& other) noexcept
+		{
+			empty += other.empty;
+			for(std::size_t i = 0; i < 4; ++i)
+				types[i] += other.types[i];
+			maxBytes = std::max(maxBytes, other.maxBytes);
+		}
+	};
+
+	// the result of a chunk; records and offsets are relative to it
+	struct ChunkResult
+	{
+		std::uint64_t records = 0;
+		std::vector<ColumnStatistics> columns;
+		std::vector<Error> errors; // the first maxErrors
+		std::uint64_t counts[problems] = {};
+
+		void add(Error const& error, std::size_t maxErrors)
+		{
+			++counts[static_cast<std::size_t>(error.problem)];
+			if(errors.size() < maxErrors)
+				errors.push_back(error);
+		}
+	};
+
+	// remembers what went wrong with the record fetched last
+	struct CheckHandler : ErrorIgnore
+	{
+		std::optional<Problem> problem;
+		std::size_t column = 0;
+		std::size_t columns = 0;
+
+		void raiseIncorrectColumns(unsigned int actual, unsigned int expected, unsigned int row) noexcept
+		{
+			(void)expected; // -Wunused-argument
+			(void)row; // -Wunused-argument
+			// a bad cell makes the reader skip the rest of the record and report the columns it counted
+			if(!problem)
+			{
+				problem = Problem::columns;
+				columns = actual;
+			}
+		}
+		void raiseUnexpectedEnd(unsigned int row) noexcept
+		{
+			(void)row; // -Wunused-argument
+			if(!problem)
+				problem = Problem::unexpectedEnd;
+		}
+		void raiseBadCell(unsigned int badColumn, unsigned int row) noexcept
+		{
+			(void)row; // -Wunused-argument
+			if(!problem)
+			{
+				problem = Problem::quoting;
+				column = badColumn;
+			}
+		}
+		void raiseBadEncoding(unsigned int badColumn, unsigned int row) noexcept
+		{
+			(void)row; // -Wunused-argument
+			if(!problem)
+			{
+				problem = Problem::encoding;
+				column = badColumn;
+			}
+		}
+	};
+
+	template<typename DelimiterMatcherT, typename EncodingT>
+	using CheckReader = Reader<char_t const*, CheckHandler, DelimiterMatcherT, char_t const*, EncodingT>;
+
+	// the reader learns the expected number of columns from the first record of the file, so that every chunk is held
+	// to the same one
+	template<typename DelimiterMatcherT, typename EncodingT>
+	ChunkResult checkChunk(string_t const& chunk, string_t const& first, Options const& options)
+	{
+		CheckReader<DelimiterMatcherT, EncodingT> reader(first.data(), first.data() + first.size(), CheckHandler(), DelimiterMatcherT(), EncodingT(), ignoreHeader);
+		reader.discard();
+		reader.reset(chunk.data(), chunk.data() + chunk.size(), keepHeader);
+
+		ChunkResult result;
+		result.columns.resize(reader.columns());
+		while(!reader.done())
+		{
+			const auto offset = static_cast<std::uint64_t>(reader.position() - chunk.data());
+			CheckHandler& handler = reader.errorHandler();
+			handler.problem.reset();
+			const std::optional<Deserializer> row = reader.fetch();
+			++result.records;
+			if(!row)
+			{
+				result.add({ handler.problem.value_or(Problem::quoting), result.records, offset, handler.column, handler.columns }, options.maxErrors);
+				continue;
+			}
+			if(!options.statistics)
+				continue;
+			for(std::size_t i = 0; i < row->total(); ++i)
+			{
+				const string_view_t cell = row->cell(i);
+				ColumnStatistics& column = result.columns[i];
+				column.maxBytes = std::max(column.maxBytes, cell.size());
+				if(const std::optional<CellType> type = Detail::cellType(cell))
+					++column.types[static_cast<std::size_t>(*type)];
+				else
+					++column.empty;
+			}
+		}
+		return result;
+	}
+
+	struct FileResult
+	{
+		ChunkResult total;
+		std::size_t expectedColumns = 0;
+		std::vector<string_t> names;
+		std::uint64_t bytes = 0;
+	};
+
+	// reads chunks on the calling thread and validates them on up to options.threads others. records which have no end
+	// within maxRecordBytes, e.g. because of an unterminated quote, are skipped up to the next line break like by
+	// Reader::limits, which bounds the memory to about (threads + 2) * chunkBytes + maxRecordBytes
+	template<typename DelimiterMatcherT, typename EncodingT>
+	FileResult checkFile(std::istream& input, bool header, Options const& options)
+	{
+		FileResult result;
+		string_t first;
+		std::deque<std::future<ChunkResult>> pending;
+		std::uint64_t offset = 0; // of the carry in the file
+		const auto merge = [&result, &options](ChunkResult const& chunk, std::uint64_t chunkOffset)
+		{
+			for(Error error : chunk.errors)
+			{
+				if(result.total.errors.size() >= options.maxErrors)
+					break;
+				error.record += result.total.records;
+				error.offset += chunkOffset;
+				result.total.errors.push_back(error);
+			}
+			for(std::size_t i = 0; i < problems; ++i)
+				result.total.counts[i] += chunk.counts[i];
+			result.total.records += chunk.records;
+			for(std::size_t i = 0; i < chunk.columns.size() && i < result.total.columns.size(); ++i)
+				result.total.columns[i].merge(chunk.columns[i]);
+		};
+		std::deque<std::uint64_t> pendingOffsets;
+		const auto drain = [&](std::size_t keep)
+		{
+			for(; pending.size() > keep; pending.pop_front(), pendingOffsets.pop_front())
+				merge(pending.front().get(), pendingOffsets.front());
+		};
+
+		string_t carry;
+		bool skipping = false; // the rest of an oversized record up to the next line break is being skipped
+		for(bool end = false; !end;)
+		{
+			string_t chunk = std::move(carry);
+			carry = string_t();
+			const std::size_t size = chunk.size();
+			chunk.resize(size + std::max(options.chunkBytes, size));
+			input.read(chunk.data() + size, static_cast<std::streamsize>(chunk.size() - size));
+			end = static_cast<std::size_t>(input.gcount()) < chunk.size() - size;
+			chunk.resize(size + static_cast<std::size_t>(input.gcount()));
+			result.bytes += static_cast<std::uint64_t>(input.gcount());
+
+			if(skipping)
+			{
+				const std::size_t newline = chunk.find_first_of("\r\n");
+				if(newline == string_t::npos)
+				{
+					offset += chunk.size();
+					continue;
+				}
+				std::size_t length = newline + 1;
+				if(chunk[newline] == '\r' && length < chunk.size() && chunk[length] == '\n')
+					++length;
+				chunk.erase(0, length);
+				offset += length;
+				skipping = false;
+			}
+
+			std::size_t length = end ? chunk.size() : Detail::recordEnd(chunk, true);
+			if(length == 0 && chunk.size() >= options.maxRecordBytes)
+			{
+				drain(0);
+				ChunkResult oversized;
+				oversized.records = 1;
+				oversized.add({ Problem::oversized, 1, 0 }, options.maxErrors);
+				merge(oversized, offset);
+				carry = std::move(chunk);
+				skipping = true;
+				continue;
+			}
+
+			if(first.empty() && length > 0)
+			{
+				// the first record defines the number of columns
+				std::size_t firstLength = Detail::recordEnd(chunk, false);
+				if(firstLength == 0)
+					firstLength = chunk.size();
+				first.assign(chunk, 0, firstLength);
+				CheckReader<DelimiterMatcherT, EncodingT> reader(first.data(), first.data() + first.size(), CheckHandler(), DelimiterMatcherT(), EncodingT(), ignoreHeader);
+				std::vector<string_t> names;
+				if(!reader.fetch(names))
+					throw MalformedFile("the first record is malformed");
+				result.expectedColumns = names.size();
+				result.total.columns.resize(names.size());
+				if(header)
+				{
+					result.names = std::move(names);
+					result.total.records = 1;
+					chunk.erase(0, firstLength);
+					offset += firstLength;
+					length -= std::min(length, firstLength);
+				}
+			}
+
+			carry.assign(chunk, length, string_t::npos);
+			chunk.resize(length);
+			if(chunk.empty())
+				continue;
+
+			drain(std::max<std::size_t>(options.threads, 1) - 1);
+			pendingOffsets.push_back(offset);
+			offset += length;
+			pending.push_back(std::async(std::launch::async, [chunk = std::move(chunk), &first, &options]
+			{
+				return checkChunk<DelimiterMatcherT, EncodingT>(chunk, first, options);
+			}));
+		}
+		drain(0);
+		return result;
+	}
+
+	template<typename DelimiterMatcherT>
+	FileResult checkFile(std::istream& input, bool header, Options const& options)
+	{
+		if(options.utf8)
+			return checkFile<DelimiterMatcherT, Utf8<>>(input, header, options);
+		return checkFile<DelimiterMatcherT, RawEncoding>(input, header, options);
+	}
+}
+
+#endif // !UCSV_TOOLS_CHECK_HPP_INCLUDED
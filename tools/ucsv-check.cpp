@@ -0,0 +1,200 @@
+/*
+ *	uCSV - a small CSV parsing and exporting library
+ *	Copyright (C) 2020 fytch (fytch@protonmail.com)
+ *	Distributed under the MIT License.
+ *	See the enclosed file LICENSE.txt for further information.
+ */
+
+// ucsv-check validates CSV files with the parsing rules of uCSV and prints their throughput and per-column statistics.
+// the input is cut into chunks at record boundaries, which are validated in parallel. exits with 0 if all files are
+// valid, 1 if one isn't and 2 if one couldn't be read
+
+#include "Check.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	using namespace uCSV;
+	using namespace uCSV::Check;
+
+	// returns the exit code of the file
+	int check(std::string const& path, Options const& options)
+	{
+		std::ifstream input(path, std::ifstream::binary);
+		if(!input)
+		{
+			std::cerr << path << ": failed to open\n";
+			return 2;
+		}
+		SniffResult sniffed;
+		try
+		{
+			sniffed = sniffFile(path);
+		}
+		catch(std::exception const& e)
+		{
+			std::cerr << path << ": " << e.what() << '\n';
+			return 2;
+		}
+		const char_t delimiter = options.delimiter != '\0' ? options.delimiter : sniffed.delimiter;
+		const bool header = options.header >= 0 ? options.header > 0 : sniffed.header;
+
+		const auto start = std::chrono::steady_clock::now();
+		FileResult result;
+		try
+		{
+			switch(delimiter)
+			{
+			case ',':
+				result = checkFile<Delimiter<','>>(input, header, options);
+				break;
+			case ';':
+				result = checkFile<Delimiter<';'>>(input, header, options);
+				break;
+			case '\t':
+				result = checkFile<Delimiter<'\t'>>(input, header, options);
+				break;
+			case '|':
+				result = checkFile<Delimiter<'|'>>(input, header, options);
+				break;
+			default:
+				std::cerr << path << ": unsupported delimiter\n";
+				return 2;
+			}
+		}
+		catch(MalformedFile const& e)
+		{
+			std::cerr << path << ": " << e.what() << '\n';
+			return 1;
+		}
+		catch(std::exception const& e)
+		{
+			std::cerr << path << ": " << e.what() << '\n';
+			return 2;
+		}
+		if(input.bad())
+		{
+			std::cerr << path << ": failed to read\n";
+			return 2;
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::uint64_t errors = 0;
+		for(const std::uint64_t count : result.total.counts)
+			errors += count;
+		std::cout << path << ": " << result.total.records << " records, " << result.expectedColumns << " columns, delimiter '"
+			<< (delimiter == '\t' ? string_t("\\t") : string_t(1, delimiter)) << "', " << (header ? "header" : "no header") << '\n';
+		std::cout << std::fixed << std::setprecision(2) << "  " << result.bytes / 1e6 << " MB in " << seconds << " s: "
+			<< result.total.records / std::max(seconds, 1e-9) / 1e6 << " M records/s, " << result.bytes / std::max(seconds, 1e-9) / 1e6 << " MB/s\n";
+		std::cout << "  " << errors << (errors == 1 ? " error\n" : " errors\n");
+		for(std::size_t i = 0; i < problems; ++i)
+			if(result.total.counts[i] > 0)
+				std::cout << "    " << problemNames[i] << ": " << result.total.counts[i] << '\n';
+		for(Error const& error : result.total.errors)
+		{
+			std::cout << "    record " << error.record << " at byte " << error.offset << ": " << problemNames[static_cast<std::size_t>(error.problem)];
+			if(error.problem == Problem::columns)
+				std::cout << ", " << error.columns << " instead of " << result.expectedColumns << " columns";
+			else if(error.problem == Problem::quoting || error.problem == Problem::encoding)
+				std::cout << " in column " << error.column;
+			std::cout << '\n';
+		}
+
+		if(options.statistics && !result.total.columns.empty())
+		{
+			std::cout << "  column\tname\tempty\tinteger\tfloating\ttimestamp\ttext\tmax bytes\n";
+			for(std::size_t i = 0; i < result.total.columns.size(); ++i)
+			{
+				ColumnStatistics const& column = result.total.columns[i];
+				std::cout << "  " << i << '\t' << (i < result.names.size() ? result.names[i] : string_t()) << '\t' << column.empty;
+				for(const CellType type : { CellType::integer, CellType::floating, CellType::timestamp, CellType::text })
+					std::cout << '\t' << column.types[static_cast<std::size_t>(type)];
+				std::cout << '\t' << column.maxBytes << '\n';
+			}
+		}
+		return errors > 0 ? 1 : 0;
+	}
+
+	void usage(std::ostream& out)
+	{
+		out << "usage: ucsv-check [options] file...\n"
+			"  -d <c>     delimiter: , ; tab or |; sniffed by default\n"
+			"  --header   the first record is a header\n"
+			"  --no-header\n"
+			"  --raw      don't validate UTF-8\n"
+			"  -j <n>     threads; defaults to the number of hardware threads minus one\n"
+			"  --errors <n>  the number of errors listed, 20 by default\n"
+			"  --chunk <bytes>  the bytes validated at once by a thread, 8 MiB by default\n"
+			"  --max-record <bytes>  longer records are reported and skipped, 64 MiB by default\n"
+			"  --no-statistics\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	std::vector<std::string> paths;
+	for(int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		const auto value = [&]() -> std::string
+		{
+			if(i + 1 >= argc)
+			{
+				usage(std::cerr);
+				std::exit(2);
+			}
+			return argv[++i];
+		};
+		if(argument == "-d")
+		{
+			const std::string delimiter = value();
+			options.delimiter = delimiter == "tab" || delimiter == "\\t" ? '\t' : delimiter.empty() ? '\0' : delimiter[0];
+		}
+		else if(argument == "--header")
+			options.header = 1;
+		else if(argument == "--no-header")
+			options.header = 0;
+		else if(argument == "--raw")
+			options.utf8 = false;
+		else if(argument == "-j")
+			options.threads = std::strtoull(value().c_str(), nullptr, 10);
+		else if(argument == "--errors")
+			options.maxErrors = std::strtoull(value().c_str(), nullptr, 10);
+		else if(argument == "--chunk")
+			options.chunkBytes = std::max<std::size_t>(std::strtoull(value().c_str(), nullptr, 10), 1);
+		else if(argument == "--max-record")
+			options.maxRecordBytes = std::strtoull(value().c_str(), nullptr, 10);
+		else if(argument == "--no-statistics")
+			options.statistics = false;
+		else if(argument == "-h" || argument == "--help")
+		{
+			usage(std::cout);
+			return 0;
+		}
+		else if(!argument.empty() && argument[0] == '-')
+		{
+			usage(std::cerr);
+			return 2;
+		}
+		else
+			paths.push_back(argument);
+	}
+	if(paths.empty())
+	{
+		usage(std::cerr);
+		return 2;
+	}
+	if(options.threads == 0)
+		options.threads = Detail::defaultThreads();
+
+	int result = 0;
+	for(std::string const& path : paths)
+		result = std::max(result, check(path, options));
+	return result;
+}